@@ -1,8 +1,11 @@
 #pragma once
 
+#include "../utilities/flat_hash_map.h"
+#include <cstddef>
+#include <cstdint>
 #include <string>
-#include <unordered_map>
-#include <unordered_set>
+#include <string_view>
+#include <utility>
 
 namespace phonemis::phonemizer::constants {
 
@@ -11,23 +14,50 @@ namespace phonemis::phonemizer::constants {
 inline constexpr int32_t kMaxSyllabeLength = 6; // See the fallback phonemization mechanism
 inline constexpr int32_t kVowelSyllabePenalty = 2;  // See the fallback phonemization mechanism
 
+// Version of the phonemization rules (the suffix, stress, special word and fallback rules).
+// Bump it on any change of the rules' logic. It is folded into the model hash of the cache files
+// along with the fingerprint of the rule tables (see kRulesFingerprint), so the files written
+// under other rules are discarded.
+inline constexpr uint64_t kRulesVersion = 1;
+
+// Word cache parameters
+namespace cache {
+inline constexpr size_t kNoShards = 16;         // Independently locked parts of the shared cache
+inline constexpr size_t kL1Size = 256;          // Entries of the per-thread front (a power of 2)
+inline constexpr size_t kSketchDepth = 4;       // Rows of the access frequency sketch
+inline constexpr size_t kSketchWidthRatio = 4;  // Sketch counters per row, relative to the shard capacity
+inline constexpr size_t kSketchResetRatio = 10; // Accesses (relative to the shard capacity) before the counts are halved
+inline constexpr size_t kFileFlushBytes = 1 << 16;  // Pending bytes appended to the cache file at once
+inline constexpr size_t kFileMaxBytes = 64 << 20;   // Size of the cache file past which no records are appended
+inline constexpr uint64_t kFileFormatVersion = 2;   // Bump on any change of the file layout
+inline constexpr int64_t kFileFlushMilliseconds = 1000;   // Age of the pending records appended to the cache file regardless of their size
+} // namespace cache
+
+// Lexicon file format
+// Entries are either plain "word": "phonemes" pairs, or objects with the keys below.
+namespace lexicon {
+inline constexpr const char* kPhonemesKey = "phonemes";
+inline constexpr const char* kDerivedKey = "derived";   // Language of an entry derived by the suffix rules (see materialize_inflections)
+inline constexpr size_t kFilterBitsPerKey = 12;         // Size of the filter rejecting the missing words
+} // namespace lexicon
+
 // Alphabet-related constants
 namespace alphabet {
-inline const std::string kVowels = "aeiouy";  // Written vowels
+inline constexpr std::string_view kVowels = "aeiouy";  // Written vowels
 inline const std::string kConsosants = "bcdfghjklmnpqrstvwxz";  // Written consosants
 
 // Acceptable number suffixes
 // Cause numbers to be converted into ordinal instead of cardinal representation
-inline const std::unordered_set<std::string> kOrdinalSuffixes = {
+inline const utilities::FlatHashSet<std::string> kOrdinalSuffixes = {
   "st", "nd", "rd", "th"
 };
 
-inline const std::unordered_map<char, std::string> kAddSymbols = {
+inline const utilities::FlatHashMap<char, std::string> kAddSymbols = {
   {'.', "dot"},
   {'/', "slash"}
 };
 
-inline const std::unordered_map<char, std::string> kSymbols = {
+inline const utilities::FlatHashMap<char, std::string> kSymbols = {
   {'%', "percent"},
   {'&', "and"},
   {'+', "plus"},
@@ -35,17 +65,17 @@ inline const std::unordered_map<char, std::string> kSymbols = {
   {'=', "equals"}
 };
 
-inline const std::unordered_set<char> kPunctations = {
+inline const utilities::FlatHashSet<char> kPunctations = {
   ';', ':', ',', '.', '!', '?', '-', '"', '\''
 };
 
-inline const std::unordered_set<char> kNonQuotePunctations = {
+inline const utilities::FlatHashSet<char> kNonQuotePunctations = {
   ';', ':', ',', '.', '!', '?', '-', '\''
 };
 
 // Acceptable currencies (with spoken text representation)
 // Maps currency signatures to it's spoken representation for both main and fractional units
-inline const std::unordered_map<char32_t, std::pair<std::string, std::string>> 
+inline const utilities::FlatHashMap<char32_t, std::pair<std::string, std::string>> 
 kCurrencies = {
   {U'$', {"dolar", "cent"}},
   {U'£', {"pound", "pence"}},
@@ -55,9 +85,15 @@ kCurrencies = {
 
 // Language (spoken) constants
 namespace language {
-inline const std::u32string kVowels = U"AIOQWYaiuæɑɒɔəɛɜɪʊʌᵻ";  // Spoken vowels
-inline const std::u32string kConsonants = U"bdfhjklmnpstvwzðŋɡɹɾʃʒʤʧθ"; // Spoken consosants
-inline const std::u32string kUSTaus = U"AIOWYiuæɑəɛɪɹʊʌ";
+inline constexpr std::u32string_view kVowels = U"AIOQWYaiuæɑɒɔəɛɜɪʊʌᵻ";  // Spoken vowels
+inline constexpr std::u32string_view kConsonants = U"bdfhjklmnpstvwzðŋɡɹɾʃʒʤʧθ"; // Spoken consosants
+inline constexpr std::u32string_view kUSTaus = U"AIOWYiuæɑəɛɪɹʊʌ";
+
+// Word endings determining the pronunciation of suffixes
+// https://en.wiktionary.org/wiki/-s, https://en.wiktionary.org/wiki/-ed
+inline constexpr std::u32string_view kHardSEndings = U"ptkfθ";     // -s pronounced as "s"
+inline constexpr std::u32string_view kSibilantEndings = U"szʃʒʧʤ"; // -s pronounced as "ᵻz"
+inline constexpr std::u32string_view kVoicelessEndings = U"pkfθʃsʧ"; // -ed pronounced as "t"
 } // namespace language
 
 // Stress calculation constants
@@ -66,5 +102,26 @@ inline constexpr char32_t kPrimary = U'ˈ';
 inline constexpr char32_t kSecondary = U'ˌ';
 } // namespace stress
 
+// Fingerprint of the rule tables, computed at compile time (see kRulesVersion)
+// Any edit of the tables changes it, so the cache files are invalidated without a manual version bump.
+inline constexpr uint64_t kRulesFingerprint = [] {
+  uint64_t hash = 0xcbf29ce484222325ULL;
+  auto add = [&hash](uint64_t value) { hash = (hash ^ value) * 0x100000001b3ULL; };
+  auto add_string = [&add](auto text) {
+    add(text.size());
+    for (auto c : text)
+      add(static_cast<uint64_t>(c));
+  };
+  add(static_cast<uint64_t>(kMaxSyllabeLength));
+  add(static_cast<uint64_t>(kVowelSyllabePenalty));
+  add_string(alphabet::kVowels);
+  for (auto table : {language::kVowels, language::kConsonants, language::kUSTaus,
+                     language::kHardSEndings, language::kSibilantEndings, language::kVoicelessEndings})
+    add_string(table);
+  add(stress::kPrimary);
+  add(stress::kSecondary);
+  return hash;
+}();
+
 
 } // phonemis::phonemizer::constants
\ No newline at end of file
@@ -0,0 +1,54 @@
+#pragma once
+
+#include "phonetics.h"
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+namespace phonemis::phonemizer {
+
+// HotWords class
+// A small table of the most frequent words with their phonemizations, placed in front of the lexicon.
+// Each entry fills exactly one cache line and holds the word and its phonemes inline, so a lookup
+// reads one or two adjacent cache lines and never touches the (much larger) lexicon dictionary.
+// A few thousand entries fit in the L2 cache, and the hottest of them stay in L1.
+// The table is read-only once built, so it is safe to share between threads.
+class HotWords {
+public:
+  static constexpr size_t kMaxWordSize = 16;    // Longer words are not stored
+  static constexpr size_t kMaxPhonemes = 10;    // Words with longer phonemizations are not stored
+
+  HotWords() = default;
+  explicit HotWords(size_t capacity);
+
+  // Adds an entry, returns false if the table is full, the word is already present or does not fit
+  bool insert(std::string_view word, const Pronunciation& pronunciation);
+
+  // Returns the stored phonemization (viewing the table's storage), if present
+  std::optional<PronunciationRef> find(std::string_view word) const;
+
+  bool empty() const { return size_ == 0; }
+  size_t size() const { return size_; }
+  size_t memory_bytes() const { return slots_.size() * sizeof(Slot); }
+
+private:
+  struct alignas(64) Slot {
+    uint8_t word_size = 0;      // 0 for empty slots
+    uint8_t no_phonemes = 0;
+    PhoneticInfo info;
+    char word[kMaxWordSize];
+    char32_t phonemes[kMaxPhonemes];
+  };
+  static_assert(sizeof(Slot) == 64);
+
+  // Helper functions - open addressing with linear probing (the table is at most 2/3 full)
+  size_t slot_index(std::string_view word) const;
+
+  std::vector<Slot> slots_;
+  size_t capacity_ = 0;
+  size_t size_ = 0;
+};
+
+} // namespace phonemis::phonemizer
@@ -1,68 +1,200 @@
 #pragma once
 
+#include "hot_words.h"
+#include "phonetics.h"
+#include "syllable_index.h"
 #include "types.h"
 #include "../tagger/tag.h"
+#include "../tokenizer/vocabulary.h"
+#include "../utilities/bloom_filter.h"
+#include "../utilities/flat_hash_map.h"
+#include <array>
 #include <optional>
+#include <span>
 #include <string>
-#include <unordered_map>
+#include <string_view>
+#include <vector>
 
 namespace phonemis::phonemizer {
 
 // Lexicon class
 // Provides phonemization of extracted tokens.
 // Wrapps a dictionary lookup for given word with additional pre/post-processing.
+// The dictionary is read-only once built (and bound), so the const queries are safe to run
+// concurrently - their scratch buffers are per-thread.
 class Lexicon {
 public:
-  Lexicon(Lang language, const std::string& dict_filepath);
+  // The hot words (optional) are the most frequent words, in the order of decreasing frequency.
+  // Those which phonemize the same way in every context are held in a small table consulted first.
+  Lexicon(Lang language, const std::string& dict_filepath, const std::vector<std::string>& hot_words = {});
+
+  // Non-copyable - the character table points into the dictionary
+  Lexicon(const Lexicon&) = delete;
+  Lexicon& operator=(const Lexicon&) = delete;
 
   // Checks if given world exists in the lexicon in any form
-  bool is_known(const std::string& word) const;
+  bool is_known(std::string_view word) const;
+
+  // Simple getters, just accessing the dictionary straight away (`entry` does not copy the phonemes)
+  std::u32string get(std::string_view word) const { return dict_.at(word).phonemes; }
+  const Pronunciation& entry(std::string_view word) const { return dict_.at(word); }
+  const Pronunciation* derived_entry(std::string_view word) const { return derived_.find(word); }   // nullptr if none
 
-  // Simple getter, just accessing the dictionary straight away
-  std::u32string get(const std::string& word) { return dict_.at(word); }
+  // Index of the short lower case entries, the syllabes of the fallback phonemization
+  const SyllableIndex& syllables() const { return syllables_; }
 
   // Returns the phonemization for given word, or "" if the phonemization failed
-  std::u32string get(const std::string& word,
-                     const tagger::Tag& tag,
+  std::u32string get(std::string_view word,
+                     tagger::Tag tag,
                      std::optional<float> base_stress = std::nullopt,
-                     std::optional<bool> vowel_next = std::nullopt);
+                     std::optional<bool> vowel_next = std::nullopt) const {
+    return std::u32string(pronounce_ref(word, tag, base_stress, vowel_next).phonemes());
+  }
+
+  // Same as `get`, but returns the phonemization along with its metadata.
+  // The word's id in the bound vocabulary (see bind), if given, saves the hashing of the word.
+  Pronunciation pronounce(std::string_view word,
+                          tagger::Tag tag,
+                          std::optional<float> base_stress = std::nullopt,
+                          std::optional<bool> vowel_next = std::nullopt,
+                          std::optional<tokenizer::WordId> id = std::nullopt) const {
+    return pronounce_ref(word, tag, base_stress, vowel_next, id).to_pronunciation();
+  }
+
+  // Same as `pronounce`, but the phonemizations taken from the lexicon unchanged are returned
+  // as views of its entries (valid as long as the lexicon), so only the words modified by
+  // the stress or suffix rules are copied.
+  PronunciationRef pronounce_ref(std::string_view word,
+                                 tagger::Tag tag,
+                                 std::optional<float> base_stress = std::nullopt,
+                                 std::optional<bool> vowel_next = std::nullopt,
+                                 std::optional<tokenizer::WordId> id = std::nullopt) const;
+
+  // Binds the dictionary entries to the ids of given vocabulary (interning the known words).
+  // Queries carrying an id are then resolved without hashing the queried word, so the ids
+  // must come from that same vocabulary. Not thread-safe, meant to be called before the queries.
+  void bind(tokenizer::Vocabulary& vocabulary);
+
+  // Returns the phonemization of a hot word, if the word is one and the tag does not change it
+  std::optional<PronunciationRef> pronounce_hot(std::string_view word,
+                                             tagger::Tag tag,
+                                             std::optional<float> base_stress = std::nullopt) const;
+
+  // Batched dictionary lookup
+  // Resolves each word with the exact and then the lower case probe (as the lookups do), nullptr if missing.
+  // All the probes are hashed and prefetched before any of them is resolved, so the memory latencies
+  // of the independent lookups overlap. The resolved entries are left in the CPU caches, which makes
+  // this a cheap warm-up for the phonemization of a whole sentence (see Phonemizer::prefetch).
+  // The words' ids in the bound vocabulary (Vocabulary::kUnknown if not interned) are optional.
+  void find_batch(std::span<const std::string_view> words,
+                  std::span<const Pronunciation*> results,
+                  std::span<const tokenizer::WordId> ids = {}) const;
+
+  // Phonemizes a lower case inflected form (-s, -ed, -ing) of a known stem with the suffix rules.
+  // Used to materialize derived entries ahead of time (see materialize_inflections),
+  // returns "" if the word is known or not resolved by the rules.
+  std::u32string derive(std::string_view word) const;
 
 private:
+  // Dictionary entries of a vocabulary word (see bind)
+  struct BoundEntry {
+    const Pronunciation* exact = nullptr;     // Entry of the word
+    const Pronunciation* lower = nullptr;     // Entry of its lower case form
+    const Pronunciation* derived = nullptr;   // Derived entry of the word
+    int special = -1;                         // Special word of its lower case form, -1 if none (see lookup_special)
+  };
+
   // Helper functions - extract phonemes without stressing
-  std::u32string get_word(const std::string& word,
-                          const tagger::Tag& tag,
-                          std::optional<float> stress,
-                          std::optional<bool> vowel_next) const;
+  // All the helpers take both the word and its lower-cased form, which is computed only once per query.
+  // The helpers probing the queried word also take its bound entry (nullptr if the word came without an id),
+  // which then replaces the probes of the word and its lower case form.
+  PronunciationRef get_word(std::string_view word,
+                            std::string_view lower,
+                            tagger::Tag tag,
+                            std::optional<float> stress,
+                            std::optional<bool> vowel_next,
+                            const BoundEntry* bound) const;
 
   // Helper functions - word+suffix phonemization
   // Phonemizes word ending with popular english suffixes, example: -ed, -s, -ing.
-  std::u32string stem_s(const std::string& word,
-                        const tagger::Tag& tag,
-                        std::optional<float> stress) const;
-  std::u32string stem_ed(const std::string& word,
-                         const tagger::Tag& tag,
-                         std::optional<float> stress) const;
-  std::u32string stem_ing(const std::string& word,
-                          const tagger::Tag& tag,
-                          std::optional<float> stress) const;
+  // The word's ending is classified once, and its candidate stems are probed in the order of preference.
+  enum class Suffix { NONE, S, ED, ING };
+  struct SuffixAnalysis {
+    Suffix suffix = Suffix::NONE;
+    std::string_view stem = {};         // The first known candidate stem
+    std::string_view stem_lower = {};
+  };
+
+  SuffixAnalysis analyze_suffix(std::string_view word, std::string_view lower) const;
+  Pronunciation stem(std::string_view word,
+                     std::string_view lower,
+                     tagger::Tag tag,
+                     std::optional<float> stress) const;
+  Pronunciation add_s(Pronunciation stem) const;
+  Pronunciation add_ed(Pronunciation stem) const;
+  Pronunciation add_ing(Pronunciation stem) const;
 
   // Helper functions - dictionary lookup with stressing
-  // Returns an empty phoneme string if failed to extract phonemes.
-  std::u32string lookup(const std::string& word,
-                        const tagger::Tag& tag,
-                        std::optional<float> stress) const;
-  std::u32string lookup_nnp(const std::string& word) const;
-  std::u32string lookup_special(const std::string& word,
-                                const tagger::Tag& tag,
-                                std::optional<float> stress,
-                                std::optional<bool> vowel_next) const;
+  // Returns an empty phoneme string if failed to extract phonemes. Entries left unchanged by the stress
+  // are returned as views of the dictionary.
+  PronunciationRef lookup(std::string_view word,
+                          std::string_view lower,
+                          tagger::Tag tag,
+                          std::optional<float> stress,
+                          const BoundEntry* bound = nullptr) const;
+  Pronunciation lookup_nnp(std::string_view word) const;
+  PronunciationRef lookup_special(std::string_view word,
+                                  std::string_view lower,
+                                  tagger::Tag tag,
+                                  std::optional<float> stress,
+                                  std::optional<bool> vowel_next,
+                                  const BoundEntry* bound) const;
+
+  // Helper functions - dictionary probing
+  // `find` returns nullptr for missing entries. The word's hash serves both the filter and the dictionary.
+  const Pronunciation* find(std::string_view word) const;
+  const Pronunciation* find(std::string_view word, size_t hash) const;
+  bool is_known(std::string_view word, std::string_view lower, const BoundEntry* bound) const;
+
+  // Probes of the word and its lower case form, served by the word's bound entry if given
+  const Pronunciation* find_exact(std::string_view word, const BoundEntry* bound) const {
+    return bound != nullptr ? bound->exact : find(word);
+  }
+  const Pronunciation* find_lower(std::string_view lower, const BoundEntry* bound) const {
+    return bound != nullptr ? bound->lower : find(lower);
+  }
+
+  // Helper functions - fills the hot words table (the dictionary must be loaded)
+  void build_hot_words(const std::vector<std::string>& words);
 
   // Resolved language
   Lang language_;
 
-  // Lookup dictionary: text -> phonemes
+  // Lookup dictionary: text -> phonemes (with metadata computed at load time)
   // Provide quick and direct phonemization for popular words.
-  std::unordered_map<std::string, std::u32string> dict_ = {};
+  utilities::FlatHashMap<std::string, Pronunciation> dict_ = {};
+
+  // Filter over the dictionary keys
+  // Most of the probes (stem candidates, fallback syllables) miss, and are rejected here.
+  utilities::BloomFilter filter_;
+
+  // Hot words: the most frequent lower case words with context independent phonemizations
+  // (apart from the NNP tag, which respells the words with no primary stress - see lookup).
+  HotWords hot_words_;
+
+  // Derived entries: inflected form -> phonemes
+  // Results of the suffix rules for lower case words with no stress and a non-NNP tag,
+  // computed when the lexicon was built. They replace the rules only in that context (see get_word).
+  utilities::FlatHashMap<std::string, Pronunciation> derived_ = {};
+
+  // Entries indexed by the ids of the bound vocabulary (see bind)
+  std::vector<BoundEntry> bound_ = {};
+
+  // Single character entries of the dictionary, indexed by the character (nullptr if missing)
+  std::array<const std::u32string*, 256> characters_ = {};
+
+  // Syllabe index: the short lower case entries, with copies of their phonemes
+  SyllableIndex syllables_;
 };
 
 } // namespace phonemis::phonemizer
\ No newline at end of file
@@ -0,0 +1,22 @@
+#pragma once
+
+#include "types.h"
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace phonemis::phonemizer {
+
+// Offline lexicon build step - materialization of inflected forms
+// Phonemizes the given words (typically a frequency list, or the vocabulary of a corpus) with the
+// -s/-ed/-ing suffix rules, and writes the lexicon extended with the results to the output file.
+// The results are stored as derived entries (tagged with the language), which resolve the frequent
+// inflections with a single lookup without changing the output. Words already present in the lexicon,
+// not in lower case or not resolved by the rules are skipped.
+// Returns the number of added entries.
+size_t materialize_inflections(Lang language,
+                               const std::string& dict_filepath,
+                               const std::vector<std::string>& words,
+                               const std::string& output_filepath);
+
+} // namespace phonemis::phonemizer
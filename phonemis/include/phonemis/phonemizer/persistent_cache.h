@@ -0,0 +1,77 @@
+#pragma once
+
+#include "word_cache.h"
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace phonemis::phonemizer {
+
+// PersistentCache class
+// A file of word phonemizations, memory-mapped for the lookups and extended by appending records.
+// The file can be shared by several processes on one host - appends are serialized with an advisory
+// file lock, and each process picks up the records appended by the others whenever it flushes its own.
+// The queued records are flushed once they are large or old enough (see constants::cache), so a process
+// killed without flushing loses at most the records of its last second.
+// The header holds a hash of the models (lexicon, language, rules version), so a file written for
+// different models is replaced by an empty one instead of being reused. The file stops growing
+// at constants::cache::kFileMaxBytes, which also bounds the indexing of the records on open.
+// The cache is safe to share between threads. POSIX systems only.
+class PersistentCache {
+public:
+  PersistentCache(const std::string& filepath, uint64_t model_hash);
+  ~PersistentCache();
+
+  PersistentCache(const PersistentCache&) = delete;
+  PersistentCache& operator=(const PersistentCache&) = delete;
+
+  // Returns the cached phonemization, if present
+  std::optional<Pronunciation> find(const WordCache::Key& key) const;
+
+  // Queues a record to be appended to the file, the queue is flushed once large or old enough
+  void insert(const WordCache::Key& key, const Pronunciation& pronunciation);
+
+  // Appends the queued records and loads the ones appended by the other processes.
+  // Called on destruction, and worth calling at the checkpoints of long running processes
+  // (e.g. after each batch of requests), so the records are shared and survive a crash.
+  void flush();
+
+  size_t no_hits() const { return no_hits_.load(std::memory_order_relaxed); }
+  size_t no_entries() const;
+
+private:
+  // Helper functions - file handling
+  void open_file(uint64_t model_hash);   // Validates or replaces the file (the file must be locked)
+  void commit();                         // Appends the queued records (the mutex must be held)
+
+  // Helper functions - mapping & indexing of the committed records (the file must be locked)
+  void refresh();
+  void index_records(const char* data, size_t begin, size_t end);
+  std::optional<Pronunciation> find_in(const char* data, const std::unordered_multimap<size_t, size_t>& index,
+                                       size_t hash, std::string_view word, uint64_t context) const;
+
+  std::string filepath_;
+  int fd_ = -1;
+
+  // Committed records (mapped from the file)
+  const char* mapping_ = nullptr;
+  size_t mapping_size_ = 0;
+  std::unordered_multimap<size_t, size_t> index_;           // Key hash -> record offset in the file
+
+  // Queued records (not yet appended)
+  std::vector<char> pending_;
+  std::unordered_multimap<size_t, size_t> pending_index_;   // Key hash -> record offset in the queue
+  std::chrono::steady_clock::time_point last_commit_ = std::chrono::steady_clock::now();
+
+  mutable std::atomic<size_t> no_hits_ = 0;
+  mutable std::shared_mutex mutex_;
+};
+
+} // namespace phonemis::phonemizer
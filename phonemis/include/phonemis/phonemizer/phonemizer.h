@@ -1,30 +1,94 @@
 #pragma once
 
 #include "lexicon.h"
+#include "persistent_cache.h"
+#include "types.h"
+#include "word_cache.h"
 #include <memory>
+#include <span>
+#include <string_view>
 
 namespace phonemis::phonemizer {
 
 // Phonemizer class
-// Combines lexicon lookup-style phonemization with rule-based fallback
+// Combines lexicon lookup-style phonemization with rule-based fallback.
+// Results can be memoized in a word cache and a persistent cache file (see Config),
+// both safe to share between threads. The phonemization methods are const and thread-safe.
 class Phonemizer {
 public:
   Phonemizer(Lang language, 
-             const std::string& lexicon_filepath = "");
+             const std::string& lexicon_filepath = "",
+             Config config = {});
   
   // Main phonemization method
   std::u32string phonemize(const std::string& word,
-                           const tagger::Tag& tag,
+                           tagger::Tag tag,
                            std::optional<float> base_stress = std::nullopt,
-                           std::optional<bool> vowel_next = std::nullopt) const;
+                           std::optional<bool> vowel_next = std::nullopt) const {
+    return std::u32string(pronounce_ref(word, tag, base_stress, vowel_next).phonemes());
+  }
+
+  // Same as `phonemize`, but returns the phonemization along with its metadata.
+  // The word's id in the bound vocabulary (see bind), if given, saves the hashing of the word in the lexicon.
+  Pronunciation pronounce(const std::string& word,
+                          tagger::Tag tag,
+                          std::optional<float> base_stress = std::nullopt,
+                          std::optional<bool> vowel_next = std::nullopt,
+                          std::optional<tokenizer::WordId> id = std::nullopt) const {
+    return pronounce_ref(word, tag, base_stress, vowel_next, id).to_pronunciation();
+  }
+
+  // Same as `pronounce`, but the phonemizations served unchanged by the lexicon are views
+  // of its entries (see Lexicon::pronounce_ref), valid as long as the phonemizer.
+  PronunciationRef pronounce_ref(const std::string& word,
+                                 tagger::Tag tag,
+                                 std::optional<float> base_stress = std::nullopt,
+                                 std::optional<bool> vowel_next = std::nullopt,
+                                 std::optional<tokenizer::WordId> id = std::nullopt) const;
+
+  // Binds the lexicon to the ids of given vocabulary (see Lexicon::bind)
+  void bind(tokenizer::Vocabulary& vocabulary);
+
+  // Warms up the lexicon entries of the upcoming words (see Lexicon::find_batch),
+  // so that their lookups overlap instead of waiting for the memory one after another
+  void prefetch(std::span<const std::string_view> words, std::span<const tokenizer::WordId> ids = {}) const;
+
+  // Word cache metrics, all zero if the cache is disabled
+  WordCacheStats cache_stats() const;
+
+  // Appends the pending records to the cache file, if enabled (see PersistentCache::flush)
+  void flush_cache() const;
 
 private:
+  // Helper functions - phonemization bypassing the cache
+  PronunciationRef pronounce_uncached(const std::string& word,
+                                      tagger::Tag tag,
+                                      std::optional<float> base_stress,
+                                      std::optional<bool> vowel_next,
+                                      std::optional<tokenizer::WordId> id) const;
+
+  // Helper functions - checks if the word is phonemized by the rules rather than by a dictionary entry
+  // (the results of the rules are the ones worth keeping in the cache file)
+  bool is_rule_based(const std::string& word) const;
+
   // Helper functions - rule-based fallback methods
   std::u32string fallback(const std::string& word,
-                          const tagger::Tag& tag) const;
+                          tagger::Tag tag) const;
+
+  // Fallback DP table cell - the shortest phonemization of a word's prefix,
+  // given by its length and the last syllabe (the characters from `start`)
+  struct FallbackCell {
+    int32_t length;
+    int32_t start;
+    const SyllableIndex::Syllable* syllable;
+  };
 
   // Lexicon component
   std::unique_ptr<Lexicon> lexicon_ = nullptr;
+
+  // Word caches (optional)
+  std::unique_ptr<WordCache> cache_ = nullptr;
+  std::unique_ptr<PersistentCache> file_cache_ = nullptr;
 };
 
 } // namespace phonemis::phonemizer
\ No newline at end of file
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <utility>
+
+namespace phonemis::phonemizer {
+
+// Phoneme classes
+// Decide how a word affects the phonemization of the following one (see Pipeline).
+enum class PhonemeClass : uint8_t {
+  NONE,           // No deciding phoneme (stress marks and other symbols are skipped)
+  VOWEL,
+  CONSONANT,
+  PUNCTUATION     // Non-quote punctuation - resets the context
+};
+
+// Last phoneme traits
+// Bit flags of the sets the last phoneme belongs to, used to attach the -s, -ed and -ing suffixes.
+namespace ending {
+inline constexpr uint16_t kHardS = 1 << 0;      // ptkfθ - followed by "s"
+inline constexpr uint16_t kSibilant = 1 << 1;   // szʃʒʧʤ - followed by "ᵻz"
+inline constexpr uint16_t kVoiceless = 1 << 2;  // pkfθʃsʧ - followed by "t"
+inline constexpr uint16_t kD = 1 << 3;
+inline constexpr uint16_t kT = 1 << 4;
+inline constexpr uint16_t kTau = 1 << 5;        // US taus (see constants::language::kUSTaus)
+inline constexpr uint16_t kTauT = 1 << 6;       // "t" preceded by a US tau - flapped before a vowel
+inline constexpr uint16_t kLong = 1 << 7;       // ə or ː
+inline constexpr uint16_t kStress = 1 << 8;     // Stress mark
+} // namespace ending
+
+// Phonetic metadata of a phonemization
+// Computed once (when the lexicon is loaded, or when a phonemization is built) and carried along
+// with the phonemes, so that the stressing, suffixing and context rules do not rescan them.
+struct PhoneticInfo {
+  bool has_primary = false;     // Contains a primary stress mark
+  bool has_secondary = false;   // Contains a secondary stress mark
+  bool has_vowel = false;
+  PhonemeClass first = PhonemeClass::NONE;   // First deciding phoneme
+  uint16_t last = 0;                          // Last phoneme traits (see ending)
+
+  bool operator==(const PhoneticInfo& other) const = default;
+};
+
+// Phonemization together with its metadata
+struct Pronunciation {
+  std::u32string phonemes;
+  PhoneticInfo info;
+
+  Pronunciation() = default;
+  Pronunciation(std::u32string phonemes, const PhoneticInfo& info)
+    : phonemes(std::move(phonemes)), info(info) {}
+  explicit Pronunciation(std::u32string phonemes);   // Computes the metadata
+
+  bool empty() const { return phonemes.empty(); }
+
+  // Appends a suffix, optionally replacing the last `no_replaced` phonemes (which must not be the first deciding one)
+  Pronunciation& append(std::u32string_view suffix, size_t no_replaced = 0);
+};
+
+// Phonemization handed out by the lookups
+// Either views phonemes stored elsewhere (a lexicon entry, which outlives the lookups), or owns
+// the phonemes built by the rules which modified them. The stored phonemes are copied only if
+// an owned Pronunciation is asked for, so the plain lookups never allocate.
+class PronunciationRef {
+public:
+  PronunciationRef() = default;
+  PronunciationRef(Pronunciation owned) : owned_(std::move(owned.phonemes)), info_(owned.info), is_owned_(true) {}
+  explicit PronunciationRef(const Pronunciation* stored)   // Views the stored phonemization (empty if nullptr)
+    : stored_(stored != nullptr ? std::u32string_view(stored->phonemes) : std::u32string_view()),
+      info_(stored != nullptr ? stored->info : PhoneticInfo()) {}
+  PronunciationRef(std::u32string_view stored, const PhoneticInfo& info) : stored_(stored), info_(info) {}
+
+  std::u32string_view phonemes() const { return is_owned_ ? std::u32string_view(owned_) : stored_; }
+  const PhoneticInfo& info() const { return info_; }
+  bool empty() const { return phonemes().empty(); }
+  bool owns() const { return is_owned_; }
+
+  // Owned copy of the phonemization (moved out of an owning rvalue)
+  Pronunciation to_pronunciation() const & { return Pronunciation(std::u32string(phonemes()), info_); }
+  Pronunciation to_pronunciation() && {
+    return is_owned_ ? Pronunciation(std::move(owned_), info_) : Pronunciation(std::u32string(stored_), info_);
+  }
+
+private:
+  std::u32string_view stored_ = {};
+  std::u32string owned_ = {};     // Viewed through `phonemes`, since moving it may relocate its characters
+  PhoneticInfo info_ = {};
+  bool is_owned_ = false;
+};
+
+// Computes the metadata of a phonemization
+PhoneticInfo analyze(std::u32string_view phonemes);
+
+} // namespace phonemis::phonemizer
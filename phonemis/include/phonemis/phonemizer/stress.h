@@ -1,11 +1,16 @@
 #pragma once
 
 #include "constants.h"
+#include "phonetics.h"
 
 namespace phonemis::phonemizer {
 
 // Applies given amount of stress to the phonemized string
 std::u32string apply_stress(const std::u32string& phonemes, float stress);
+Pronunciation apply_stress(const Pronunciation& pronunciation, float stress);   // Reuses the metadata
+
+// Checks if apply_stress modifies the phonemes with given metadata (otherwise, they are returned unchanged)
+bool changes_stress(const PhoneticInfo& info, float stress);
 
 // Moves the stress mark so that the stress is placed directly before the nearest vowel
 std::u32string restress(const std::u32string& phonemes);
@@ -0,0 +1,88 @@
+#pragma once
+
+#include "constants.h"
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace phonemis::phonemizer {
+
+// SyllableIndex class
+// A compact trie of the short lower case dictionary entries (at most kMaxSyllabeLength letters),
+// the syllabes of the fallback phonemization. All the syllabes starting at a position of a word
+// are enumerated in a single walk, instead of hashing each candidate into the whole dictionary.
+// The phonemes are copied into one contiguous pool, along with the facts the fallback's
+// post-processing needs, so the index does not touch the dictionary once built.
+// The index is read-only once built, so it is safe to share between threads.
+class SyllableIndex {
+public:
+  static constexpr uint16_t kNoStress = UINT16_MAX;
+
+  // Indexed syllabe
+  struct Syllable {
+    uint32_t offset = 0;          // Position of the phonemes in the pool
+    uint16_t no_phonemes = 0;
+    uint16_t primary = kNoStress; // Position of the first primary stress mark, kNoStress if none
+    bool silent_e = false;        // Ends with 'e' phonemized as a consonant (see Phonemizer::fallback)
+  };
+
+  SyllableIndex();
+
+  // Indexes given entries (text -> phonemes). Entries which are not syllabes (longer than
+  // kMaxSyllabeLength or not made of the a-z letters) and the empty phonemizations are skipped.
+  explicit SyllableIndex(std::vector<std::pair<std::string_view, std::u32string_view>> entries);
+
+  // Calls `visit(size, syllable)` for each indexed syllabe the text starts with, the shortest first
+  template <typename Visitor>
+  void match(std::string_view text, Visitor&& visit) const {
+    const size_t max_size = std::min(text.size(), static_cast<size_t>(constants::kMaxSyllabeLength));
+    const Node* node = &nodes_[0];
+    for (size_t i = 0; i < max_size; i++) {
+      const uint32_t letter = static_cast<unsigned char>(text[i]) - 'a';
+      const uint32_t bit = letter < kNoLetters ? uint32_t(1) << letter : 0;
+      if ((node->children & bit) == 0)
+        return;
+      node = &nodes_[node->first_child + std::popcount(node->children & (bit - 1))];
+      if (node->syllable != kNoSyllable)
+        visit(i + 1, syllables_[node->syllable]);
+    }
+  }
+
+  std::u32string_view phonemes(const Syllable& syllable) const {
+    return std::u32string_view(phonemes_).substr(syllable.offset, syllable.no_phonemes);
+  }
+
+  size_t size() const { return syllables_.size(); }
+  size_t memory_bytes() const {
+    return nodes_.size() * sizeof(Node) + syllables_.size() * sizeof(Syllable) + phonemes_.size() * sizeof(char32_t);
+  }
+
+private:
+  static constexpr uint32_t kNoLetters = 26;
+  static constexpr uint32_t kNoSyllable = UINT32_MAX;
+
+  // Trie node, the children of a node are stored next to each other in the order of their letters
+  struct Node {
+    uint32_t children = 0;                // Bit mask of the children's letters
+    uint32_t first_child = 0;
+    uint32_t syllable = kNoSyllable;      // Syllabe ending at the node, if any
+  };
+
+  // Helper functions - builds the subtrie of the keys sharing their first `depth` letters
+  void build(uint32_t node,
+             const std::vector<std::pair<std::string_view, std::u32string_view>>& entries,
+             size_t begin,
+             size_t end,
+             size_t depth);
+
+  std::vector<Node> nodes_;             // The root comes first
+  std::vector<Syllable> syllables_;
+  std::u32string phonemes_;
+};
+
+} // namespace phonemis::phonemizer
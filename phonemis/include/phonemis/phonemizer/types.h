@@ -1,5 +1,9 @@
 #pragma once
 
+#include <cstddef>
+#include <string>
+#include <string_view>
+
 namespace phonemis::phonemizer {
 
 // Available languages (english variants)
@@ -10,4 +14,42 @@ enum class Lang {
   DEFAULT = EN_US
 };
 
+inline constexpr std::string_view to_string(Lang language) {
+  return language == Lang::EN_GB ? "en-gb" : "en-us";
+}
+
+// Phonemizer configuration
+struct Config {
+  // Word cache parameters
+  size_t cache_capacity = 0;    // Maximal number of cached word phonemizations, 0 disables the cache
+
+  // Persistent cache file, shared by the processes using the same models and kept between restarts.
+  // Holds the words phonemized by the rules (not found in the lexicon), see PersistentCache.
+  // Empty path disables the persistent cache. POSIX systems only.
+  std::string cache_filepath = "";
+
+  // Hot words list - a text file with one word per line, the most frequent words first
+  // (further columns, like the word counts, are ignored). The first words of the list are served
+  // from a small, cache resident table in front of the lexicon. Empty path disables the table.
+  std::string hot_words_filepath = "";
+  size_t hot_words_capacity = 2048;   // Number of the words taken from the list
+};
+
+// Word cache metrics
+struct WordCacheStats {
+  size_t no_hits = 0;           // Lookups served by the cache (including the per-thread front)
+  size_t no_l1_hits = 0;        // Lookups served by the per-thread front
+  size_t no_misses = 0;
+  size_t no_evictions = 0;
+  size_t no_rejections = 0;     // New entries not admitted, since they were less popular than the evicted ones
+  size_t no_entries = 0;
+  size_t no_file_hits = 0;      // Misses served by the persistent cache file
+  size_t no_file_entries = 0;   // Entries of the persistent cache file
+
+  double hit_rate() const {
+    const size_t no_lookups = no_hits + no_misses;
+    return no_lookups > 0 ? static_cast<double>(no_hits) / no_lookups : 0.0;
+  }
+};
+
 } // namespace phonemis::phonemizer
\ No newline at end of file
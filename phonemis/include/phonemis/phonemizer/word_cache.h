@@ -0,0 +1,132 @@
+#pragma once
+
+#include "constants.h"
+#include "phonetics.h"
+#include "types.h"
+#include "../tagger/tag.h"
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace phonemis::phonemizer {
+
+// WordCache class
+// A bounded, concurrent cache of word phonemizations, keyed by (word, tag, base stress, vowel_next).
+// Lookups go through two levels:
+// - a small, direct-mapped front private to each thread (L1), which serves the hottest words without locking,
+// - a shared map, split into independently locked shards (L2).
+// Since word frequencies are heavily skewed, a full shard admits a new entry only if it is estimated
+// to be accessed more often than the one it would evict (approximate counts of recent accesses),
+// and picks the evicted entries in CLOCK order, which spares the recently hit ones.
+class WordCache {
+public:
+  // Cache key
+  struct Key {
+    std::string_view word;
+    tagger::Tag tag;
+    std::optional<float> base_stress;
+    std::optional<bool> vowel_next;
+  };
+
+  explicit WordCache(size_t capacity);
+
+  // Returns the cached phonemization, if present
+  std::optional<Pronunciation> find(const Key& key);
+
+  // Stores a phonemization computed after a failed `find`
+  void insert(const Key& key, const Pronunciation& pronunciation);
+
+  WordCacheStats stats() const;
+
+  // Packs the key fields other than the word into a single integer
+  static uint64_t context(const Key& key);
+
+private:
+  // Keys are stored as the word and a packed (tag, base stress, vowel_next) context
+  struct StoredKey {
+    std::string word;
+    uint64_t context;
+    size_t hash;
+  };
+  struct KeyView {
+    std::string_view word;
+    uint64_t context;
+    size_t hash;
+  };
+
+  // Transparent hashing & comparison, so that the maps can be probed without building the keys
+  struct KeyHash {
+    using is_transparent = void;
+    size_t operator()(const StoredKey& key) const noexcept { return key.hash; }
+    size_t operator()(const KeyView& key) const noexcept { return key.hash; }
+  };
+  struct KeyEqual {
+    using is_transparent = void;
+    template <typename A, typename B>
+    bool operator()(const A& a, const B& b) const noexcept {
+      return a.hash == b.hash && a.context == b.context && a.word == b.word;
+    }
+  };
+
+  struct Entry {
+    Pronunciation pronunciation;
+    bool referenced = false;    // Second chance bit of the CLOCK eviction
+  };
+  using Map = std::unordered_map<StoredKey, Entry, KeyHash, KeyEqual>;
+
+  // A single, independently locked part of the cache
+  struct alignas(64) Shard {
+    std::mutex mutex;
+    Map entries;                          // Reserved up front, so the iterators stay valid
+    std::vector<Map::iterator> clock;     // Entries in the CLOCK order
+    size_t hand = 0;
+
+    // Access frequency sketch - small saturating counters, halved periodically
+    std::vector<uint8_t> sketch;
+    size_t no_accesses = 0;
+
+    std::atomic<size_t> no_hits = 0;
+    std::atomic<size_t> no_l1_hits = 0;
+    std::atomic<size_t> no_misses = 0;
+    std::atomic<size_t> no_evictions = 0;
+    std::atomic<size_t> no_rejections = 0;
+  };
+
+  // Per-thread front entry
+  struct L1Entry {
+    uint64_t owner = 0;   // Id of the cache the entry belongs to (0 - empty)
+    size_t hash = 0;
+    uint64_t context = 0;
+    std::string word;
+    Pronunciation pronunciation;
+  };
+  using L1 = std::array<L1Entry, constants::cache::kL1Size>;
+
+  // Helper functions - keys
+  static KeyView view(const Key& key);
+  Shard& shard(size_t hash) const { return shards_[hash % constants::cache::kNoShards]; }
+
+  // Helper functions - L1
+  static L1& l1();
+  void fill_l1(const KeyView& key, const Pronunciation& pronunciation) const;
+
+  // Helper functions - frequency sketch (shard lock must be held)
+  size_t sketch_index(size_t hash, size_t row) const;
+  void record_access(Shard& shard, size_t hash) const;
+  uint8_t estimate(const Shard& shard, size_t hash) const;
+
+  uint64_t id_;   // Unique among all the caches ever created
+  size_t shard_capacity_;
+  size_t sketch_width_;
+  std::unique_ptr<Shard[]> shards_;
+};
+
+} // namespace phonemis::phonemizer
@@ -3,6 +3,7 @@
 #include "preprocessor/tools.h"
 #include "tokenizer/tokenize.h"
 #include "tagger/tagger.h"
+#include "tokenizer/vocabulary.h"
 #include "phonemizer/phonemizer.h"
 #include <memory>
 
@@ -17,13 +18,23 @@ using tagger::Tagger;
 // tokenization and tagging to final Phonemizer call.
 // Tagger and Lexicon .json data files are theoretically optional, but
 // skipping these arguments will significantly impact the phonemization quality.
+// The tagger configuration allows to trade some tagging accuracy for speed (see tagger::Mode),
+// while the phonemizer configuration enables the word cache.
 class Pipeline {
 public:
   Pipeline(Lang language,
            const std::string& tagger_data_filepath = "",
-           const std::string& lexicon_data_filepath = "");
+           const std::string& lexicon_data_filepath = "",
+           tagger::Config tagger_config = {},
+           phonemizer::Config phonemizer_config = {});
   
-  std::u32string process(const std::string& text);
+  // Phonemizes given text
+  // Safe to call concurrently on a shared pipeline - the components are read-only once constructed,
+  // the scratch state lives in per-call or per-thread buffers, and the caches synchronize themselves.
+  std::u32string process(const std::string& text) const;
+
+  // Appends the pending records to the phonemizer's cache file, if enabled (see PersistentCache::flush)
+  void flush_cache() const { phonemizer_->flush_cache(); }
 
 private:
   Lang language_;
@@ -31,6 +42,10 @@ private:
   // Pipeline subcomponents
   std::unique_ptr<Phonemizer> phonemizer_ = nullptr;
   std::unique_ptr<Tagger> tagger_ = nullptr;
+
+  // Words known to the tagger and the lexicon, both bound to the vocabulary ids.
+  // Tokens are looked up once during tokenization, and resolved by their ids afterwards.
+  std::unique_ptr<tokenizer::Vocabulary> vocabulary_ = std::make_unique<tokenizer::Vocabulary>();
 };
 
 } // namespace phonemis
\ No newline at end of file
@@ -1,9 +1,8 @@
 #pragma once
 
+#include "../utilities/flat_hash_map.h"
 #include <cstdint>
 #include <string>
-#include <unordered_map>
-#include <unordered_set>
 
 namespace phonemis::preprocessor {
 
@@ -12,7 +11,7 @@ namespace phonemis::preprocessor {
 // -------------------
 namespace num2words::constants {
 // Cards map: basic number -> word
-inline const std::unordered_map<int, std::string> kCardinals = {
+inline const utilities::FlatHashMap<int, std::string> kCardinals = {
     {0, "zero"}, {1, "one"}, {2, "two"}, {3, "three"}, {4, "four"}, {5, "five"},
     {6, "six"}, {7, "seven"}, {8, "eight"}, {9, "nine"}, {10, "ten"},
     {11, "eleven"}, {12, "twelve"}, {13, "thirteen"}, {14, "fourteen"},
@@ -22,13 +21,13 @@ inline const std::unordered_map<int, std::string> kCardinals = {
 };
 
 // Ordinal exceptions: cardinal word -> ordinal word
-inline const std::unordered_map<std::string, std::string> kOrdinals = {
+inline const utilities::FlatHashMap<std::string, std::string> kOrdinals = {
     {"one", "first"}, {"two", "second"}, {"three", "third"}, {"five", "fifth"},
     {"eight", "eighth"}, {"nine", "ninth"}, {"twelve", "twelfth"}
 };
 
 // Large scale names: scale value -> name
-inline const std::unordered_map<std::int64_t, std::string> kLargeCardinals = {
+inline const utilities::FlatHashMap<std::int64_t, std::string> kLargeCardinals = {
     {100, "hundred"}, {1000, "thousand"}, {1000000, "million"},
     {1000000000LL, "billion"}, {1000000000000LL, "trillion"}
 };
@@ -39,7 +38,7 @@ inline const std::unordered_map<std::int64_t, std::string> kLargeCardinals = {
 // ----------------------------
 namespace unicode::constants {
 // Foreign character to latin-only conversion
-inline const std::unordered_map<char32_t, std::string> kForeignToLatin = {
+inline const utilities::FlatHashMap<char32_t, std::string> kForeignToLatin = {
     // Polish
     {U'Ą', "A"}, {U'ą', "a"}, {U'Ć', "C"}, {U'ć', "c"}, {U'Ę', "E"}, {U'ę', "e"},
     {U'Ł', "L"}, {U'ł', "l"}, {U'Ń', "N"}, {U'ń', "n"}, {U'Ó', "O"}, {U'ó', "o"},
@@ -93,7 +92,7 @@ inline const std::unordered_map<char32_t, std::string> kForeignToLatin = {
 // ---------------
 namespace constants {
 // These are all characters that should end a correct english sentence
-inline const std::unordered_set<char> kEndOfSentenceCharacters = {
+inline const utilities::FlatHashSet<char> kEndOfSentenceCharacters = {
     '.', '?', '!', ';'
 };
 } // namespace text2sentences::constants
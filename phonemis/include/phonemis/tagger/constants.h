@@ -1,18 +1,28 @@
 #pragma once
 
-#include "tag.h"
-#include <unordered_set>
+#include <cstddef>
 
 namespace phonemis::tagger::constants {
 
-// Punctuation and special symbol tags
-inline const std::unordered_set<Tag> kPunctationTags = {
-  Tag("."), Tag(","), 
-  Tag("-LRB-"), Tag("-RRB-"), 
-  Tag("``"), Tag("\"\""), Tag("''"), 
-  Tag(":"), 
-  Tag("$"), Tag("#"), 
-  Tag("NFP")
-};
+// Viterbi hyperparameters
+// A workaround for zero probability - used for missing emissions and transitions.
+inline constexpr double kEpsilon = 1e-6;
+
+// Batched Viterbi parameters
+// Number of sentences decoded together - each sentence occupies a single SIMD lane.
+inline constexpr size_t kBatchLanes = 8;
+inline constexpr size_t kMinBatchLanes = 3;   // Smaller batches fall back to sentence by sentence decoding
+
+// Anchor-split parameters
+// Minimal number of tokens processed by a single task - shorter segments are merged.
+inline constexpr size_t kMinSegmentTaskLength = 64;
+
+// Chunked Viterbi parameters
+// Minimal number of tokens per chunk - shorter sentences use fewer threads.
+inline constexpr size_t kMinChunkLength = 64;
+
+// Streaming parameters
+// Maximal number of newer tokens a token waits for before its tag is committed.
+inline constexpr size_t kDefaultStreamingLag = 4;
 
 } // namespace phonemis::tagger::constants
\ No newline at end of file
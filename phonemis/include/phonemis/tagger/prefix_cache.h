@@ -0,0 +1,74 @@
+#pragma once
+
+#include "types.h"
+#include "workspace.h"
+#include "../tokenizer/tokens.h"
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace phonemis::tagger {
+
+// PrefixCache class
+// A bounded cache of Viterbi columns, shared by the sentences starting with the same tokens.
+// Each column depends only on the tokens up to its position, so a sentence sharing a prefix
+// with a previously tagged one can resume the recursion right after the cached part.
+// Cached prefixes form a trie, where each node is identified by the hash of its parent's key
+// and its own token. Least recently used nodes are evicted once the memory budget is exceeded.
+// The cache is safe to share between threads.
+class PrefixCache {
+public:
+  explicit PrefixCache(size_t capacity_bytes);
+
+  // Restores the columns of the longest cached prefix into the workspace tables
+  // (offsets, states, emit, v, back_pointer) and returns the length of the prefix.
+  size_t restore(const std::vector<tokenizer::Token>& sentence, Workspace& workspace);
+
+  // Stores the columns [from, sentence.size()) of a decoded sentence
+  void store(const std::vector<tokenizer::Token>& sentence, size_t from, const Workspace& workspace);
+
+  PrefixCacheStats stats() const;
+
+private:
+  // A single cached column, with the token it belongs to
+  struct Node {
+    uint64_t parent_key;
+    std::string word;
+    std::vector<TagIndex> states;
+    std::vector<double> emit;
+    std::vector<double> v;
+    std::vector<uint32_t> back_pointer;
+    std::list<uint64_t>::iterator lru_it;
+
+    size_t memory() const;
+  };
+
+  // Helper functions - trie navigation
+  // Keys are chained from the root, so that equal keys mean equal prefixes (up to hash collisions,
+  // which are ruled out by comparing the parent keys and words).
+  static uint64_t child_key(uint64_t parent_key, const std::string& word);
+  const Node* find(uint64_t key, uint64_t parent_key, const std::string& word) const;
+
+  // Helper functions - eviction
+  void evict();
+
+  size_t capacity_bytes_;
+  std::unordered_map<uint64_t, Node> nodes_;
+  std::list<uint64_t> lru_;   // Most recently used first
+
+  // Metrics
+  size_t memory_bytes_ = 0;
+  size_t no_hits_ = 0;
+  size_t no_misses_ = 0;
+  size_t no_restored_columns_ = 0;
+  size_t no_computed_columns_ = 0;
+  size_t no_evictions_ = 0;
+
+  mutable std::mutex mutex_;
+};
+
+} // namespace phonemis::tagger
@@ -0,0 +1,82 @@
+#pragma once
+
+#include "constants.h"
+#include "tagger.h"
+#include <cstddef>
+#include <optional>
+#include <vector>
+
+namespace phonemis::tagger {
+
+// StreamingTagger class
+// An online, fixed-lag variant of the Viterbi tagger for incrementally arriving text.
+// Tokens are fed one at a time and leave the tagger with their final tags:
+// - as soon as all the surviving Viterbi paths agree on them (as the full Viterbi would, up to exact ties), or
+// - at the latest once `lag` newer tokens have arrived (the best path at that moment is committed).
+// The tagger follows the candidate expansion of the underlying Tagger (full or sparse). The pruning modes
+// (Mode::BEAM, Mode::GREEDY) are not supported, since a forced emission recomputes the pending columns,
+// which pruning would have already cut down.
+// The columns are recycled, so once warmed up, the tagger performs no heap allocation of its own.
+class StreamingTagger {
+public:
+  // Throws std::invalid_argument if the tagger is configured with a pruning mode
+  explicit StreamingTagger(const Tagger& tagger, size_t lag = constants::kDefaultStreamingLag);
+
+  // Feeds the next token
+  // Tokens whose tags became final are appended to `finalized` (in order).
+  void push(tokenizer::Token token, std::vector<tokenizer::Token>& finalized);
+
+  // Finalizes all the pending tokens and starts a new sentence
+  // Should be called at the end of each sentence (or the entire stream).
+  void flush(std::vector<tokenizer::Token>& finalized);
+
+  // Number of tokens still waiting for their final tags
+  size_t pending() const { return no_pending_; }
+
+private:
+  // A pending token with its Viterbi column
+  struct Column {
+    tokenizer::Token token;
+    std::vector<TagIndex> states;
+    std::vector<double> emit_scores;
+    std::vector<double> v;
+    std::vector<uint32_t> back_pointer;   // Previous state's position in the preceding column
+  };
+
+  // Helper functions - ring of the pending columns
+  // The idx-th pending column, the oldest one first
+  Column& column(size_t idx) { return ring_[(head_ + idx) % ring_.size()]; }
+  Column& push_column();    // Claims the slot following the newest column (reusing its buffers)
+  void pop_column();        // Releases the oldest column's slot
+
+  // Helper functions - Viterbi recursion
+  // Computes the scores of given column from the preceding one, or from the committed
+  // anchor state if the column is the first pending one.
+  void advance(size_t idx);
+
+  // Helper functions - finalization
+  // Emits the first `count` pending tokens along the path leading to `slot` in the column `count - 1`.
+  void emit(size_t count, size_t slot, std::vector<tokenizer::Token>& finalized);
+
+  // Finds the latest column through which all the surviving paths go,
+  // returning the number of tokens which can be emitted and the converged slot.
+  std::optional<std::pair<size_t, size_t>> converged();
+
+  const Tagger& tagger_;
+  size_t lag_;
+
+  // Pending tokens & their Viterbi columns, held in a ring of slots which keep their buffers.
+  // The ring grows only when all of its slots are pending.
+  std::vector<Column> ring_;
+  size_t head_ = 0;         // Slot of the oldest pending column
+  size_t no_pending_ = 0;
+
+  // State of the latest finalized token in the current sentence
+  std::optional<TagIndex> anchor_ = std::nullopt;
+
+  // Reusable buffers
+  Workspace workspace_;
+  std::vector<uint32_t> slots_, next_slots_;
+};
+
+} // namespace phonemis::tagger
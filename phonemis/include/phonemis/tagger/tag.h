@@ -1,38 +1,133 @@
 #pragma once
 
-#include "../utilities/string_utils.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <ostream>
+#include <stdexcept>
 #include <string>
+#include <string_view>
 
 namespace phonemis::tagger {
 
-using namespace utilities;
+// Tag categories
+// Bit flags grouping related tags, so that a tag can be tested against an entire group at once.
+enum class TagCategory : uint8_t {
+  NOUN = 1 << 0,          // NN, NNS, NNP, NNPS
+  VERB = 1 << 1,          // VB, VBD, VBG, VBN, VBP, VBZ
+  ADJ = 1 << 2,           // JJ, JJR, JJS
+  ADV = 1 << 3,           // RB, RBR, RBS
+  PROPER_NOUN = 1 << 4,   // NNP, NNPS
+  PUNCTUATION = 1 << 5    // Punctuation and special symbols
+};
 
 // Tag class definition
-// An abstraction layer which wrapps a simple string-based tag definition
-// with some additional logic.
-class Tag : public std::string {
+// A compact identifier of a PoS (Part of Speech) tag from the Penn Treebank set (see data/tags.json).
+// Tags are interned - they compare as integers and never allocate.
+class Tag {
 public:
-  // Inherit constructors and assignment from std::string
-  using std::string::string;
-  using std::string::operator=;
-  Tag(std::string const& s) : std::string(s) {}
-  Tag(std::string&& s) : std::string(std::move(s)) {}
+  enum Id : uint8_t {
+    NONE,             // "" - no tag
+    DOLLAR,           // $
+    CLOSING_QUOTE,    // ''
+    COMMA,            // ,
+    LRB,              // -LRB-
+    RRB,              // -RRB-
+    PERIOD,           // .
+    COLON,            // :
+    ADD, AFX, CC, CD, DT, EX, FW, HYPH, IN, JJ, JJR, JJS, LS, MD, NFP,
+    NN, NNP, NNPS, NNS, PDT, POS, PRP,
+    PRP_POSSESSIVE,   // PRP$
+    RB, RBR, RBS, RP, SYM, TO, UH, VB, VBD, VBG, VBN, VBP, VBZ, WDT, WP,
+    WP_POSSESSIVE,    // WP$
+    WRB, XX,
+    SPACE,            // _SP
+    OPENING_QUOTE,    // ``
+    NEGATION,         // !
+
+    // Coarse-grained parent tags
+    NOUN, VERB, ADJ, ADV,
+
+    COUNT
+  };
+
+  constexpr Tag() = default;
+  constexpr Tag(Id id) : id_(id) {}
+
+  // Parses the string form of a tag, throws std::invalid_argument for unknown tags
+  explicit constexpr Tag(std::string_view name) {
+    for (size_t i = 0; i < COUNT; i++) {
+      if (kNames[i] == name) {
+        id_ = static_cast<Id>(i);
+        return;
+      }
+    }
+    throw std::invalid_argument("Unknown tag: " + std::string(name));
+  }
+
+  constexpr Id id() const { return id_; }
+  constexpr std::string_view name() const { return kNames[id_]; }
 
   // Extra logic
-  Tag parent_tag() const {
-    auto this_tag = static_cast<const std::string&>(*this);
-    if (this_tag == "VERB" || string_utils::starts_with(this_tag, "VB"))
-      return {"VERB"};
-    if (this_tag == "NOUN" || string_utils::starts_with(this_tag, "NN"))
-      return {"NOUN"};
-    if (string_utils::starts_with(this_tag, "ADV") || string_utils::starts_with(this_tag, "RB"))
-      return {"ADV"};
-    if (string_utils::starts_with(this_tag, "ADJ") || string_utils::starts_with(this_tag, "JJ"))
-      return {"ADJ"};
-    return (*this);
+  constexpr Tag parent_tag() const { return kParents[id_]; }
+  constexpr bool is(TagCategory category) const {
+    return (kCategories[id_] & static_cast<uint8_t>(category)) != 0;
   }
+
+  constexpr bool operator==(const Tag& other) const = default;
+
+private:
+  static constexpr std::array<std::string_view, COUNT> kNames = {
+    "", "$", "''", ",", "-LRB-", "-RRB-", ".", ":",
+    "ADD", "AFX", "CC", "CD", "DT", "EX", "FW", "HYPH", "IN", "JJ", "JJR", "JJS", "LS", "MD", "NFP",
+    "NN", "NNP", "NNPS", "NNS", "PDT", "POS", "PRP",
+    "PRP$",
+    "RB", "RBR", "RBS", "RP", "SYM", "TO", "UH", "VB", "VBD", "VBG", "VBN", "VBP", "VBZ", "WDT", "WP",
+    "WP$",
+    "WRB", "XX",
+    "_SP",
+    "``",
+    "!",
+    "NOUN", "VERB", "ADJ", "ADV"
+  };
+
+  // Parent tags - a coarse-grained tag for verbs, nouns, adjectives and adverbs, the tag itself otherwise
+  static constexpr std::array<Id, COUNT> kParents = [] {
+    std::array<Id, COUNT> parents = {};
+    for (size_t i = 0; i < COUNT; i++)
+      parents[i] = static_cast<Id>(i);
+    for (Id id : {NN, NNP, NNPS, NNS}) parents[id] = NOUN;
+    for (Id id : {VB, VBD, VBG, VBN, VBP, VBZ}) parents[id] = VERB;
+    for (Id id : {JJ, JJR, JJS}) parents[id] = ADJ;
+    for (Id id : {RB, RBR, RBS}) parents[id] = ADV;
+    return parents;
+  }();
+
+  // Category bit masks
+  static constexpr std::array<uint8_t, COUNT> kCategories = [] {
+    std::array<uint8_t, COUNT> categories = {};
+    for (size_t i = 0; i < COUNT; i++) {
+      const Id parent = kParents[i];
+      categories[i] = parent == NOUN ? static_cast<uint8_t>(TagCategory::NOUN) :
+                      parent == VERB ? static_cast<uint8_t>(TagCategory::VERB) :
+                      parent == ADJ ? static_cast<uint8_t>(TagCategory::ADJ) :
+                      parent == ADV ? static_cast<uint8_t>(TagCategory::ADV) : 0;
+    }
+    for (Id id : {NNP, NNPS})
+      categories[id] |= static_cast<uint8_t>(TagCategory::PROPER_NOUN);
+    for (Id id : {PERIOD, COMMA, LRB, RRB, OPENING_QUOTE, CLOSING_QUOTE, COLON, DOLLAR, NFP})
+      categories[id] |= static_cast<uint8_t>(TagCategory::PUNCTUATION);
+    return categories;
+  }();
+
+  Id id_ = NONE;
 };
 
+inline std::ostream& operator<<(std::ostream& os, const Tag& tag) {
+  return os << tag.name();
+}
+
 } // namespace phonemis::tagger
 
 // Hash definition
@@ -41,8 +136,7 @@ namespace std {
 template<>
 struct hash<phonemis::tagger::Tag> {
   size_t operator()(phonemis::tagger::Tag const& t) const noexcept {
-    // Use std::string's hash implementation
-    return std::hash<std::string>()(static_cast<std::string const&>(t));
+    return static_cast<size_t>(t.id());
   }
 };
-} // namespace std
\ No newline at end of file
+} // namespace std
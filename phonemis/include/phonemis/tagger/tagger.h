@@ -1,10 +1,17 @@
 #pragma once
 
+#include "prefix_cache.h"
 #include "tag.h"
+#include "types.h"
+#include "workspace.h"
 #include "../tokenizer/tokens.h"
+#include "../tokenizer/vocabulary.h"
+#include "../utilities/flat_hash_map.h"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
 #include <string>
-#include <unordered_map>
-#include <unordered_set>
+#include <utility>
 #include <vector>
 
 namespace phonemis::tagger {
@@ -13,24 +20,105 @@ namespace phonemis::tagger {
 // Provides PoS (Part of Speech) tagging functionality.
 // Requires a previous tokenization of the text (tokenizer module).
 // A modification of the Viterbi algorithm for bigram HMM (Hidden Markov Model) tagger.
+// The model is read-only once loaded (and bound), so the tagging methods are safe to call
+// concurrently, as long as each thread uses its own workspace (the default one is per-thread).
 class Tagger {
 public:
-  explicit Tagger(const std::string& hmm_data_path);
+  explicit Tagger(const std::string& hmm_data_path, Config config = {});
 
   // Main tagging method - a modified Viterbi algorithm
   // Works in place bo modyfing the 'tag' fields.
+  // In exact Viterbi mode, sentences of at least `parallel_threshold` tokens are decoded on multiple threads.
+  // The variant without a workspace uses a thread-local one.
   void tag(std::vector<tokenizer::Token>& sentence) const;
+  void tag(std::vector<tokenizer::Token>& sentence, Workspace& workspace) const;
+
+  // Batched tagging method
+  // Tags many sentences at once. In exact Viterbi mode, sentences of similar length
+  // are decoded together, with their trellis columns interleaved (structure of arrays),
+  // so that the recursion vectorizes across sentences. The results are the same as
+  // when tagging the sentences one by one.
+  void tag_batch(std::vector<std::vector<tokenizer::Token>>& sentences) const;
+  void tag_batch(std::vector<std::vector<tokenizer::Token>>& sentences, Workspace& workspace) const;
+
+  // Binds the emission rows to the ids of given vocabulary (interning the known words).
+  // Tokens carrying an id (see tokenizer::tokenize) are then resolved without hashing their text,
+  // so they must be looked up in that same vocabulary. Not thread-safe, meant to be called before tagging.
+  void bind(tokenizer::Vocabulary& vocabulary);
+
+  // Prefix cache metrics (all zeros if the cache is disabled)
+  PrefixCacheStats prefix_cache_stats() const;
 
 private:
+  friend class StreamingTagger;
+
+  // Sparse emission row: (tag index, log-probability) pairs sorted by tag index
+  using EmissionRow = std::vector<std::pair<TagIndex, double>>;
+
+  // Helper functions - Viterbi column preparation
+  // Fills the candidate tags and their emission scores for given token (and alternative word).
+  // In sparse mode, only the tags observed with any of the words are expanded.
+  void candidates(const tokenizer::Token& token,
+                  const std::string* alt_word,
+                  Workspace& workspace) const;
+
+  // Returns the emission row of given token or word, or nullptr for unknown words
+  const EmissionRow* emission_row(const tokenizer::Token& token) const;
+  const EmissionRow* emission_row(const std::string& word) const;
+
+  // Returns the lower-cased version of the sentence's first word, or nullptr if it does not apply.
+  // To make the algorithm less case-sensitive, the first word is probed in both forms.
+  const std::string* lowerized_first(const std::string& first_word,
+                                     Workspace& workspace) const;
+
+  // Helper functions - Viterbi passes over the workspace tables
+  // `advance` computes the scores of column t from column t - 1, `backtrack` reads the best path.
+  void advance(Workspace& workspace, size_t t) const;
+  void backtrack(std::vector<tokenizer::Token>& sentence, Workspace& workspace) const;
+
+  double transition_score(TagIndex prev, TagIndex curr) const {
+    return transition_scores_[prev * tags_.size() + curr];
+  }
+
+  // Helper functions - anchor-split Viterbi
+  // Decodes the segments between single-tag words independently (see Mode::ANCHOR_SPLIT).
+  void tag_segments(std::vector<tokenizer::Token>& sentence, Workspace& workspace) const;
+
+  // Helper functions - chunked Viterbi
+  // Decodes long sentences in chunks processed on multiple threads, followed by a sequential fix-up.
+  // Each column is normalized (its best score is shifted to 0), which makes the fix-up exact.
+  void tag_chunks(std::vector<tokenizer::Token>& sentence, Workspace& workspace) const;
+  void normalize(Workspace& workspace, size_t t) const;
+
+  // Helper functions - batched Viterbi
+  // Decodes up to kBatchLanes sentences simultaneously, one sentence per lane.
+  void tag_lanes(std::vector<tokenizer::Token>* const* lanes, size_t no_lanes,
+                 Workspace& workspace) const;
+
+  // Helper functions - beam pruning
+  // Drops the hypotheses of the last Viterbi column which fall out of the beam.
+  void prune(Workspace& workspace, size_t column_begin, size_t beam_width) const;
+
+  // Resolved decoding configuration
+  Config config_;
+
   // Set of possible tags (states)
-  std::unordered_set<Tag> tags_;
-
-  // Probability maps - loaded from the input json file.
-  std::unordered_map<Tag, double> start_probs_ = {};
-  std::unordered_map<Tag, std::unordered_map<std::string, double>>
-    emission_probs_ = {};
-  std::unordered_map<Tag, std::unordered_map<Tag, double>>
-    transition_probs_ = {};
+  // Tags are identified by their position in `tags_`, which allows
+  // to keep all the probability tables as flat arrays.
+  std::vector<Tag> tags_;
+
+  // Log-probability tables - loaded from the input json file.
+  // Missing entries are replaced with log(kEpsilon).
+  std::vector<double> start_scores_ = {};       // [tag]
+  std::vector<double> transition_scores_ = {};  // [prev_tag * no_tags + curr_tag]
+  utilities::FlatHashMap<std::string, EmissionRow> emission_scores_ = {};  // word -> sparse row
+
+  // Emission rows indexed by the ids of the bound vocabulary (nullptr for words with no emissions)
+  const tokenizer::Vocabulary* vocabulary_ = nullptr;
+  std::vector<const EmissionRow*> emission_rows_ = {};
+
+  // Cached Viterbi columns of recently tagged sentence prefixes (optional)
+  std::unique_ptr<PrefixCache> prefix_cache_ = nullptr;
 };
 
-} // namespace phonemis::tagger
\ No newline at end of file
+} // namespace phonemis::tagger
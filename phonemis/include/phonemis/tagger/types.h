@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace phonemis::tagger {
+
+// Tag indices
+// Within the tagger, tags are identified by their position in the tag set.
+using TagIndex = uint16_t;
+
+// Available decoding modes
+// Determine how the tagger searches for the most probable tag sequence.
+enum class Mode {
+  VITERBI,          // Exact Viterbi over the entire tag set
+  SPARSE_VITERBI,   // Viterbi restricted to the tags observed with each word
+  BEAM,             // Viterbi keeping only the best few hypotheses per word
+  GREEDY,           // Left-to-right decoding, choosing the best tag word by word
+  ANCHOR_SPLIT,     // Sparse Viterbi, decoding the segments between single-tag words independently
+
+  DEFAULT = VITERBI
+};
+
+// Tagger configuration
+// Trades tagging accuracy for speed - only the exact Viterbi is guaranteed
+// to find the most probable tag sequence.
+struct Config {
+  Mode mode = Mode::DEFAULT;
+
+  // Beam search parameters (Mode::BEAM only)
+  size_t beam_width = 4;      // Maximal number of hypotheses kept per word
+  double beam_margin = 10.0;  // Maximal log-probability distance to the best hypothesis
+
+  // Parallel decoding parameters (Mode::VITERBI & Mode::ANCHOR_SPLIT only)
+  size_t parallel_threshold = 256;  // Minimal sentence length (in tokens) decoded on multiple threads
+  size_t parallel_chunks = 0;       // Maximal number of chunks (Mode::VITERBI), 0 for one per thread of the shared pool
+
+  // Prefix cache parameters (all the modes, except for parallel decoding)
+  size_t prefix_cache_bytes = 0;    // Memory budget for the cached Viterbi columns, 0 disables the cache
+};
+
+// Prefix cache metrics
+struct PrefixCacheStats {
+  size_t no_hits = 0;               // Sentences resumed from a cached prefix
+  size_t no_misses = 0;             // Sentences decoded from scratch
+  size_t no_restored_columns = 0;   // Viterbi columns taken from the cache
+  size_t no_computed_columns = 0;   // Viterbi columns computed
+  size_t no_evictions = 0;
+  size_t no_entries = 0;            // Columns currently in the cache
+  size_t memory_bytes = 0;          // Approximate memory used by the cache
+
+  // Fraction of the Viterbi columns taken from the cache
+  double hit_rate() const {
+    const size_t no_columns = no_restored_columns + no_computed_columns;
+    return no_columns > 0 ? static_cast<double>(no_restored_columns) / no_columns : 0.0;
+  }
+};
+
+} // namespace phonemis::tagger
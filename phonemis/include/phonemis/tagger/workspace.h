@@ -0,0 +1,66 @@
+#pragma once
+
+#include "types.h"
+#include "../tokenizer/tokens.h"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace phonemis::tagger {
+
+// Workspace class
+// Holds the Viterbi trellis & backpointer buffers used by the Tagger.
+// The buffers grow geometrically and keep their capacity between calls,
+// so once warmed up, tagging with a reused workspace performs no heap allocation.
+// A workspace must not be used by more than one thread at a time.
+class Workspace {
+public:
+  Workspace() = default;
+
+  // Releases all the memory held by the buffers
+  void clear();
+
+private:
+  friend class Tagger;
+  friend class StreamingTagger;
+  friend class PrefixCache;
+
+  // Resizes the buffer, growing its capacity geometrically if needed
+  template <typename T>
+  static void ensure(std::vector<T>& buffer, size_t size) {
+    if (buffer.capacity() < size)
+      buffer.reserve(std::max(size, 2 * buffer.capacity()));
+    buffer.resize(size);
+  }
+
+  // Sequential Viterbi tables
+  // Columns are stored one after another, where offsets[t] marks the beginning of column t.
+  std::vector<size_t> offsets;
+  std::vector<TagIndex> states;         // states[offsets[t] + i] -> i-th candidate tag
+  std::vector<double> emit;             // emit[offsets[t] + i] -> emission log-probability
+  std::vector<double> v;                // v[offsets[t] + i] -> log-probability
+  std::vector<uint32_t> back_pointer;   // back_pointer[offsets[t] + i] -> previous state's position in column t - 1
+
+  // Anchor-split & chunked Viterbi - anchor positions & ranges of columns processed together
+  std::vector<size_t> anchors;
+  std::vector<std::pair<size_t, size_t>> tasks;
+
+  // Batched Viterbi tables (structure of arrays, [tag][lane])
+  std::vector<double> lanes_v;
+  std::vector<double> lanes_v_next;
+  std::vector<double> lanes_emit;
+  std::vector<TagIndex> lanes_back_pointer;   // [t][tag][lane]
+  std::vector<std::vector<tokenizer::Token>*> lanes_order;  // Sentences sorted by length
+
+  // Per-column scratch buffers
+  std::vector<TagIndex> column_tags;
+  std::vector<double> emit_scores;
+  std::vector<double> beam_scores;
+  std::vector<double> column_scores;
+  std::string lowerized;
+};
+
+} // namespace phonemis::tagger
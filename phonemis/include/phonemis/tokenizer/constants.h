@@ -1,9 +1,9 @@
 #pragma once
 
 #include "types.h"
+#include "../utilities/flat_hash_map.h"
 #include <array>
 #include <string>
-#include <unordered_set>
 
 namespace phonemis::tokenizer::constants {
   
@@ -18,7 +18,7 @@ namespace phonemis::tokenizer::constants {
   // A set of special words, which can contain special characters as
   // an integral part.
   // Note that all of the words are lower case.
-  inline const std::unordered_set<std::string> kSpecialWords = {
+  inline const utilities::FlatHashSet<std::string> kSpecialWords = {
     // Contractions
     "'bout", "'d", "'em", "'ll", "'m", "'re", "'s", "'ve",
     "can't", "cain't", "goin'", "let's", "ma'am", "musn't", "n't",
@@ -2,6 +2,7 @@
 
 #include "tokens.h"
 #include "types.h"
+#include "vocabulary.h"
 #include <string>
 #include <vector>
 
@@ -9,6 +10,7 @@ namespace phonemis::tokenizer {
 
 // Tokenizes the input text into a vector of strings (tokens).
 // Follows specific rules for special characters and special words.
-std::vector<Token> tokenize(const std::string& text);
+// If a vocabulary is given, each token gets its id from it.
+std::vector<Token> tokenize(const std::string& text, const Vocabulary* vocabulary = nullptr);
 
 } // namespace phonemis::tokenizer
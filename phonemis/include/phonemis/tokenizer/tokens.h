@@ -1,5 +1,6 @@
 #pragma once
 
+#include "vocabulary.h"
 #include "../tagger/tag.h"
 #include <optional>
 #include <string>
@@ -13,6 +14,7 @@ struct Token {
 	std::string text;
 	std::string whitespace = ""; 		// Following whitespace
 	bool is_first = false;					// Whether it is a first token in the sentence
+	WordId id = Vocabulary::kUnknown;				// Vocabulary id, kUnknown if not interned or not looked up
 
   // Extras
   std::optional<tagger::Tag> tag = std::nullopt;	// A PoS (Part of Speech) tag, example: NN (noun)
@@ -0,0 +1,47 @@
+#pragma once
+
+#include "../utilities/flat_hash_map.h"
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <string_view>
+
+namespace phonemis::tokenizer {
+
+// Word ids
+// Identify the words of a Vocabulary by their position in it.
+using WordId = uint32_t;
+
+// Vocabulary class
+// Interns words, mapping each distinct string to a dense id. The tagger and the lexicon bind
+// their per-word data (emission rows, dictionary entries) to the ids of a shared vocabulary,
+// so that a token looked up once during tokenization is resolved by plain indexing afterwards.
+// Interning is not thread-safe, lookups are (once the vocabulary is no longer extended).
+class Vocabulary {
+public:
+  static constexpr WordId kUnknown = UINT32_MAX;    // Id of the words which are not interned
+
+  Vocabulary() = default;
+
+  // Non-copyable - the ids refer to the word strings held by the vocabulary
+  Vocabulary(const Vocabulary&) = delete;
+  Vocabulary& operator=(const Vocabulary&) = delete;
+
+  // Returns the word's id, adding the word if needed
+  WordId intern(std::string_view word);
+
+  // Returns the word's id, or kUnknown if the word is not interned
+  WordId find(std::string_view word) const {
+    const WordId* id = ids_.find(word);
+    return id != nullptr ? *id : kUnknown;
+  }
+
+  std::string_view word(WordId id) const { return words_[id]; }
+  size_t size() const { return words_.size(); }
+
+private:
+  std::deque<std::string> words_ = {};                        // id -> word (never relocated)
+  utilities::FlatHashMap<std::string_view, WordId> ids_ = {};  // word (viewing into words_) -> id
+};
+
+} // namespace phonemis::tokenizer
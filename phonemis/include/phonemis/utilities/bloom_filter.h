@@ -0,0 +1,75 @@
+#pragma once
+
+#include "prefetch.h"
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace phonemis::utilities {
+
+// BloomFilter class
+// A compact set membership filter over key hashes - it never rejects an inserted key,
+// and accepts a missing one only with a small probability (about 0.5% at 12 bits per key).
+// The filter is blocked: all the bits of a key lie in a single cache line, so a query
+// touches one cache line only. An empty (default constructed) filter accepts everything.
+class BloomFilter {
+public:
+  BloomFilter() = default;
+  BloomFilter(size_t no_keys, size_t bits_per_key)
+    : blocks_(std::max<size_t>(1, (no_keys * bits_per_key + kBlockBits - 1) / kBlockBits)) {}
+
+  void insert(uint64_t hash) {
+    if (blocks_.empty())
+      return;
+    hash = mix(hash);
+    Block& block = blocks_[block_index(hash)];
+    uint64_t bits = mix(hash);
+    for (size_t i = 0; i < kNoProbes; i++, bits >>= 9)
+      block[(bits >> 6) & 7] |= uint64_t(1) << (bits & 63);
+  }
+
+  bool may_contain(uint64_t hash) const {
+    if (blocks_.empty())
+      return true;
+    hash = mix(hash);
+    const Block& block = blocks_[block_index(hash)];
+    uint64_t bits = mix(hash);
+    for (size_t i = 0; i < kNoProbes; i++, bits >>= 9) {
+      if ((block[(bits >> 6) & 7] & (uint64_t(1) << (bits & 63))) == 0)
+        return false;
+    }
+    return true;
+  }
+
+  // Starts loading the block of given key, for a `may_contain` query issued shortly after
+  void prefetch(uint64_t hash) const {
+    if (!blocks_.empty())
+      utilities::prefetch(&blocks_[block_index(mix(hash))]);
+  }
+
+  size_t memory_bytes() const { return blocks_.size() * sizeof(Block); }
+
+private:
+  static constexpr size_t kBlockBits = 512;
+  static constexpr size_t kNoProbes = 6;    // Bits set per key, 9 hash bits each
+
+  struct alignas(64) Block : std::array<uint64_t, kBlockBits / 64> {};
+
+  // Helper functions - the block is picked by the high bits of the mixed hash, the bits within it by the hash mixed again.
+  // Mixing makes the filter independent of the quality (and width) of the key hashes.
+  size_t block_index(uint64_t hash) const {
+    return static_cast<size_t>(((hash >> 32) * blocks_.size()) >> 32);
+  }
+  static uint64_t mix(uint64_t hash) {
+    // splitmix64 finalizer
+    hash = (hash ^ (hash >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    hash = (hash ^ (hash >> 27)) * 0x94d049bb133111ebULL;
+    return hash ^ (hash >> 31);
+  }
+
+  std::vector<Block> blocks_;
+};
+
+} // namespace phonemis::utilities
@@ -0,0 +1,478 @@
+#pragma once
+
+#include "prefetch.h"
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+// The SSE2 probing can be disabled with PHONEMIS_FLAT_HASH_NO_SSE2 (e.g. to test the portable fallback)
+#if !defined(PHONEMIS_FLAT_HASH_NO_SSE2) && \
+    (defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#include <emmintrin.h>
+#define PHONEMIS_FLAT_HASH_SSE2
+#endif
+
+namespace phonemis::utilities {
+
+// -------------------------------------
+// Fast hashing
+// -------------------------------------
+
+namespace hash_detail {
+inline constexpr uint64_t kSecret0 = 0xa0761d6478bd642fULL;
+inline constexpr uint64_t kSecret1 = 0xe7037ed1a0b428dbULL;
+
+inline uint64_t load64(const char* data) {
+  uint64_t value;
+  std::memcpy(&value, data, sizeof(value));
+  return value;
+}
+
+inline uint64_t load32(const char* data) {
+  uint32_t value;
+  std::memcpy(&value, data, sizeof(value));
+  return value;
+}
+
+// Multiplies to 128 bits and folds the halves together
+inline uint64_t mix(uint64_t a, uint64_t b) {
+#if defined(__SIZEOF_INT128__)
+  const __uint128_t product = static_cast<__uint128_t>(a) * b;
+  return static_cast<uint64_t>(product) ^ static_cast<uint64_t>(product >> 64);
+#else
+  const uint64_t a_lo = a & 0xffffffffULL, a_hi = a >> 32;
+  const uint64_t b_lo = b & 0xffffffffULL, b_hi = b >> 32;
+  const uint64_t lo_lo = a_lo * b_lo, hi_lo = a_hi * b_lo, lo_hi = a_lo * b_hi, hi_hi = a_hi * b_hi;
+  const uint64_t cross = (lo_lo >> 32) + (hi_lo & 0xffffffffULL) + lo_hi;
+  return ((cross << 32) | (lo_lo & 0xffffffffULL)) ^ (hi_hi + (hi_lo >> 32) + (cross >> 32));
+#endif
+}
+} // namespace hash_detail
+
+// Non-cryptographic 64-bit hash of a byte string (wyhash-style multiply & fold).
+// Strings of up to 16 bytes - most of the words - are read with four overlapping loads, without loops.
+inline uint64_t hash_bytes(const char* data, size_t size) {
+  using namespace hash_detail;
+  uint64_t seed = kSecret0, a = 0, b = 0;
+  if (size <= 16) {
+    if (size >= 4) {
+      const size_t shift = (size >> 3) << 2;   // 0 for 4-7 bytes, 4 for 8-16 bytes
+      a = (load32(data) << 32) | load32(data + shift);
+      b = (load32(data + size - 4) << 32) | load32(data + size - 4 - shift);
+    }
+    else if (size > 0) {
+      a = (static_cast<uint64_t>(static_cast<uint8_t>(data[0])) << 16) |
+          (static_cast<uint64_t>(static_cast<uint8_t>(data[size >> 1])) << 8) |
+          static_cast<uint8_t>(data[size - 1]);
+    }
+  }
+  else {
+    size_t remaining = size;
+    for (; remaining > 16; data += 16, remaining -= 16)
+      seed = mix(load64(data) ^ kSecret1, load64(data + 8) ^ seed);
+    a = load64(data + remaining - 16);
+    b = load64(data + remaining - 8);
+  }
+  return mix(kSecret1 ^ size, mix(a ^ kSecret1, b ^ seed));
+}
+
+// Hash functors of the flat hash tables
+// Integral and enum keys are mixed, string keys are hashed with hash_bytes. The string hash
+// is transparent - std::string keys can be queried with string views, without temporary strings.
+template <typename T>
+struct FlatHash {
+  static_assert(std::is_integral_v<T> || std::is_enum_v<T>, "No FlatHash for this key type");
+  size_t operator()(T value) const noexcept {
+    return static_cast<size_t>(hash_detail::mix(static_cast<uint64_t>(value) ^ hash_detail::kSecret0,
+                                                hash_detail::kSecret1));
+  }
+};
+
+struct FlatStringHash {
+  using is_transparent = void;
+  size_t operator()(std::string_view str) const noexcept {
+    return static_cast<size_t>(hash_bytes(str.data(), str.size()));
+  }
+};
+
+template <> struct FlatHash<std::string> : FlatStringHash {};
+template <> struct FlatHash<std::string_view> : FlatStringHash {};
+
+// -------------------------------------
+// Flat hash tables
+// -------------------------------------
+
+// FlatHashTable class
+// An open-addressing hash table storing the entries inline, in a single array (no per-entry nodes).
+// Each slot has a control byte, holding 7 bits of the key's hash (or marking the slot as empty or deleted).
+// A lookup probes groups of 16 control bytes at once (with SSE2 where available), so that only
+// the slots whose hash bits match are compared, and most of the misses end within the first group.
+// The table is at most 7/8 full, and doubles its capacity when growing.
+//
+// Unlike the standard unordered containers:
+// - `find` returns a pointer to the value (nullptr if missing), so no `contains` + `at` double probes are needed,
+// - lookups accept any key type the hash and the equality accept (e.g. string views for string keys),
+// - inserting may move the entries, invalidating the pointers and iterators (erasing does not),
+// - the keys of a map are not const, and must not be modified through the iterators.
+//
+// Value = void makes a set (see FlatHashMap & FlatHashSet).
+template <typename Key, typename Value, typename Hash = FlatHash<Key>, typename KeyEqual = std::equal_to<>>
+class FlatHashTable {
+  static constexpr bool kIsMap = !std::is_void_v<Value>;
+
+public:
+  using key_type = Key;
+  using value_type = std::conditional_t<kIsMap, std::pair<Key, Value>, Key>;
+  using found_type = std::conditional_t<kIsMap, Value, const Key>;    // Type pointed by the results of `find`
+
+  FlatHashTable() = default;
+  FlatHashTable(std::initializer_list<value_type> values) {
+    reserve(values.size());
+    for (const auto& value : values)
+      insert(value);
+  }
+
+  FlatHashTable(const FlatHashTable& other) {
+    reserve(other.size_);
+    for (const auto& value : other)
+      insert(value);
+  }
+  FlatHashTable(FlatHashTable&& other) noexcept { swap(other); }
+  FlatHashTable& operator=(FlatHashTable other) noexcept {
+    swap(other);
+    return *this;
+  }
+  ~FlatHashTable() { release(); }
+
+  void swap(FlatHashTable& other) noexcept {
+    std::swap(ctrl_, other.ctrl_);
+    std::swap(slots_, other.slots_);
+    std::swap(capacity_, other.capacity_);
+    std::swap(size_, other.size_);
+    std::swap(growth_left_, other.growth_left_);
+  }
+
+  // Iteration (in no particular order)
+  template <bool kConst>
+  class Iterator {
+  public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = FlatHashTable::value_type;
+    using difference_type = std::ptrdiff_t;
+    using reference = std::conditional_t<kConst || !kIsMap, const value_type&, value_type&>;
+    using pointer = std::conditional_t<kConst || !kIsMap, const value_type*, value_type*>;
+
+    Iterator() = default;
+    reference operator*() const { return table_->slots_[index_]; }
+    pointer operator->() const { return &table_->slots_[index_]; }
+    Iterator& operator++() {
+      index_++;
+      skip_free();
+      return *this;
+    }
+    Iterator operator++(int) {
+      Iterator it = *this;
+      ++*this;
+      return it;
+    }
+    bool operator==(const Iterator& other) const { return index_ == other.index_; }
+
+  private:
+    friend class FlatHashTable;
+    using Table = std::conditional_t<kConst, const FlatHashTable, FlatHashTable>;
+
+    Iterator(Table* table, size_t index) : table_(table), index_(index) { skip_free(); }
+    void skip_free() {
+      while (index_ < table_->capacity_ && table_->ctrl_[index_] < 0)
+        index_++;
+    }
+
+    Table* table_ = nullptr;
+    size_t index_ = 0;
+  };
+  using iterator = Iterator<false>;
+  using const_iterator = Iterator<true>;
+
+  iterator begin() { return iterator(this, 0); }
+  iterator end() { return iterator(this, capacity_); }
+  const_iterator begin() const { return const_iterator(this, 0); }
+  const_iterator end() const { return const_iterator(this, capacity_); }
+
+  // Lookups
+  // The variants taking the hash let the callers compute it once for several purposes (see `hash`).
+  template <typename K>
+  found_type* find(const K& key) { return find(key, hash(key)); }
+  template <typename K>
+  const found_type* find(const K& key) const { return find(key, hash(key)); }
+  template <typename K>
+  found_type* find(const K& key, size_t key_hash) {
+    const size_t index = find_index(key, key_hash);
+    return index != kNone ? &found(slots_[index]) : nullptr;
+  }
+  template <typename K>
+  const found_type* find(const K& key, size_t key_hash) const {
+    const size_t index = find_index(key, key_hash);
+    return index != kNone ? &found(slots_[index]) : nullptr;
+  }
+
+  template <typename K>
+  bool contains(const K& key) const { return find(key) != nullptr; }
+  template <typename K>
+  size_t count(const K& key) const { return contains(key) ? 1 : 0; }
+
+  template <typename K>
+  found_type& at(const K& key) requires kIsMap {
+    if (auto* value = find(key))
+      return *value;
+    throw std::out_of_range("FlatHashTable::at: missing key");
+  }
+  template <typename K>
+  const found_type& at(const K& key) const requires kIsMap {
+    if (const auto* value = find(key))
+      return *value;
+    throw std::out_of_range("FlatHashTable::at: missing key");
+  }
+
+  // Hash of given key, as used by the table
+  template <typename K>
+  size_t hash(const K& key) const { return hash_(key); }
+
+  // Starts loading the first probed group of given hash, for a lookup issued shortly after
+  void prefetch(size_t key_hash) const {
+    if (capacity_ == 0)
+      return;
+    const size_t group = first_group(key_hash);
+    utilities::prefetch(ctrl_ + group);
+    utilities::prefetch(slots_ + group);
+  }
+
+  // Insertion
+  // Existing entries are never overwritten - the returned flag tells if the entry was inserted.
+  template <typename K, typename... Args>
+  std::pair<found_type*, bool> try_emplace(K&& key, Args&&... args) requires kIsMap {
+    const auto [index, inserted] = emplace_key(std::forward<K>(key), std::forward<Args>(args)...);
+    return {&slots_[index].second, inserted};
+  }
+  template <typename K>
+  found_type& operator[](K&& key) requires kIsMap {
+    return *try_emplace(std::forward<K>(key)).first;
+  }
+
+  std::pair<found_type*, bool> insert(const value_type& value) {
+    if constexpr (kIsMap) {
+      return try_emplace(value.first, value.second);
+    }
+    else {
+      const auto [index, inserted] = emplace_key(value);
+      return {&slots_[index], inserted};
+    }
+  }
+
+  // Removal - returns true if the key was present
+  template <typename K>
+  bool erase(const K& key) {
+    const size_t index = find_index(key, hash(key));
+    if (index == kNone)
+      return false;
+    std::destroy_at(&slots_[index]);
+    ctrl_[index] = kDeleted;
+    size_--;
+    return true;
+  }
+
+  void clear() {
+    release();
+    ctrl_ = nullptr;
+    slots_ = nullptr;
+    capacity_ = size_ = growth_left_ = 0;
+  }
+
+  // Grows the table, so that it can hold given number of entries without rehashing
+  void reserve(size_t no_entries) {
+    if (no_entries > size_ + growth_left_)
+      rehash(capacity_for(no_entries));
+  }
+
+  size_t size() const { return size_; }
+  bool empty() const { return size_ == 0; }
+  size_t memory_bytes() const { return capacity_ * (sizeof(value_type) + sizeof(ctrl_t)); }
+
+private:
+  // Control bytes
+  // Non-negative values hold the low 7 bits of the hash of the slot's key.
+  using ctrl_t = int8_t;
+  static constexpr ctrl_t kEmpty = -128;
+  static constexpr ctrl_t kDeleted = -2;
+
+  static constexpr size_t kGroupWidth = 16;
+  static constexpr size_t kNone = SIZE_MAX;
+
+  // Group of control bytes, probed at once
+  // Returned masks have a bit set for each matching slot of the group.
+  struct Group {
+#ifdef PHONEMIS_FLAT_HASH_SSE2
+    explicit Group(const ctrl_t* ctrl) : bytes(_mm_load_si128(reinterpret_cast<const __m128i*>(ctrl))) {}
+    uint32_t match(ctrl_t h2) const {
+      return static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(h2), bytes)));
+    }
+    uint32_t match_free() const { return static_cast<uint32_t>(_mm_movemask_epi8(bytes)); }   // Sign bits - empty or deleted
+
+    __m128i bytes;
+#else
+    explicit Group(const ctrl_t* ctrl) { std::memcpy(bytes, ctrl, kGroupWidth); }
+    uint32_t match(ctrl_t h2) const {
+      uint32_t mask = 0;
+      for (size_t i = 0; i < kGroupWidth; i++)
+        mask |= static_cast<uint32_t>(bytes[i] == h2) << i;
+      return mask;
+    }
+    uint32_t match_free() const {
+      uint32_t mask = 0;
+      for (size_t i = 0; i < kGroupWidth; i++)
+        mask |= static_cast<uint32_t>(bytes[i] < 0) << i;
+      return mask;
+    }
+
+    ctrl_t bytes[kGroupWidth];
+#endif
+    uint32_t match_empty() const { return match(kEmpty); }
+  };
+
+  // Helper functions - slot access
+  static const Key& key_of(const value_type& slot) {
+    if constexpr (kIsMap) return slot.first;
+    else return slot;
+  }
+  static found_type& found(value_type& slot) {
+    if constexpr (kIsMap) return slot.second;
+    else return slot;
+  }
+  static const found_type& found(const value_type& slot) {
+    if constexpr (kIsMap) return slot.second;
+    else return slot;
+  }
+
+  // Helper functions - probing
+  // Groups are aligned, and probed in triangular steps, which visit every group of a power of 2 sized table.
+  // The low bits of the hash are stored in the control bytes, the high ones pick the first group.
+  static ctrl_t h2(size_t key_hash) { return static_cast<ctrl_t>(key_hash & 0x7F); }
+  size_t first_group(size_t key_hash) const { return (key_hash >> 7) & (capacity_ - 1) & ~(kGroupWidth - 1); }
+
+  template <typename K>
+  size_t find_index(const K& key, size_t key_hash) const {
+    if (capacity_ == 0)
+      return kNone;
+    const ctrl_t tag = h2(key_hash);
+    size_t group = first_group(key_hash);
+    for (size_t step = kGroupWidth;; group = (group + step) & (capacity_ - 1), step += kGroupWidth) {
+      const Group probe(ctrl_ + group);
+      for (uint32_t mask = probe.match(tag); mask != 0; mask &= mask - 1) {
+        const size_t index = group + std::countr_zero(mask);
+        if (eq_(key_of(slots_[index]), key))
+          return index;
+      }
+      if (probe.match_empty() != 0)
+        return kNone;
+    }
+  }
+
+  size_t find_free(size_t key_hash) const {
+    size_t group = first_group(key_hash);
+    for (size_t step = kGroupWidth;; group = (group + step) & (capacity_ - 1), step += kGroupWidth) {
+      if (const uint32_t mask = Group(ctrl_ + group).match_free(); mask != 0)
+        return group + std::countr_zero(mask);
+    }
+  }
+
+  // Helper functions - insertion of a new key (the slot's control byte is set once the entry is constructed)
+  template <typename K, typename... Args>
+  std::pair<size_t, bool> emplace_key(K&& key, Args&&... args) {
+    size_t key_hash = hash(key);
+    if (const size_t index = find_index(key, key_hash); index != kNone)
+      return {index, false};
+
+    if (growth_left_ == 0)
+      rehash(capacity_for(std::max<size_t>(2 * size_, size_ + 1)));
+
+    const size_t index = find_free(key_hash);
+    if constexpr (kIsMap) {
+      std::construct_at(&slots_[index], std::piecewise_construct,
+                        std::forward_as_tuple(std::forward<K>(key)),
+                        std::forward_as_tuple(std::forward<Args>(args)...));
+    }
+    else {
+      std::construct_at(&slots_[index], std::forward<K>(key));
+    }
+    growth_left_ -= ctrl_[index] == kEmpty;
+    ctrl_[index] = h2(key_hash);
+    size_++;
+    return {index, true};
+  }
+
+  // Helper functions - storage
+  static size_t capacity_for(size_t no_entries) {
+    return std::bit_ceil(std::max(kGroupWidth, no_entries + (no_entries + 6) / 7));
+  }
+
+  void rehash(size_t capacity) {
+    FlatHashTable table;
+    table.ctrl_ = static_cast<ctrl_t*>(::operator new(capacity, std::align_val_t(kGroupWidth)));
+    std::memset(table.ctrl_, static_cast<unsigned char>(kEmpty), capacity);
+    table.slots_ = std::allocator<value_type>().allocate(capacity);
+    table.capacity_ = capacity;
+    table.growth_left_ = capacity - capacity / 8;
+
+    for (size_t i = 0; i < capacity_; i++) {
+      if (ctrl_[i] < 0)
+        continue;
+      const size_t key_hash = hash(key_of(slots_[i]));
+      const size_t index = table.find_free(key_hash);
+      std::construct_at(&table.slots_[index], std::move(slots_[i]));
+      table.ctrl_[index] = h2(key_hash);
+      table.size_++;
+      table.growth_left_--;
+    }
+    swap(table);
+  }
+
+  void release() {
+    if (ctrl_ == nullptr)
+      return;
+    for (size_t i = 0; i < capacity_; i++) {
+      if (ctrl_[i] >= 0)
+        std::destroy_at(&slots_[i]);
+    }
+    std::allocator<value_type>().deallocate(slots_, capacity_);
+    ::operator delete(ctrl_, std::align_val_t(kGroupWidth));
+  }
+
+  ctrl_t* ctrl_ = nullptr;          // Control bytes (aligned to the group width)
+  value_type* slots_ = nullptr;     // Entries, constructed in the full slots only
+  size_t capacity_ = 0;             // 0 or a power of 2, at least the group width
+  size_t size_ = 0;
+  size_t growth_left_ = 0;          // Empty slots which can be filled before rehashing
+
+  [[no_unique_address]] Hash hash_;
+  [[no_unique_address]] KeyEqual eq_;
+};
+
+template <typename Key, typename Value, typename Hash = FlatHash<Key>, typename KeyEqual = std::equal_to<>>
+using FlatHashMap = FlatHashTable<Key, Value, Hash, KeyEqual>;
+
+template <typename Key, typename Hash = FlatHash<Key>, typename KeyEqual = std::equal_to<>>
+using FlatHashSet = FlatHashTable<Key, void, Hash, KeyEqual>;
+
+} // namespace phonemis::utilities
@@ -1,8 +1,10 @@
 #pragma once
 
+#include <cstdint>
 #include <filesystem>
 #include <fstream>
 #include <string>
+#include <vector>
 #include "../../third-party/json.hpp"
 
 namespace phonemis::utilities::io_utils {
@@ -33,4 +35,42 @@ inline nlohmann::json load_json(const std::string& fp) {
   return json_obj;
 }
 
+// Text file parsing
+// Returns the first whitespace separated field of each non-empty line (up to `max_words` of them), in the file order.
+// Used for word lists, which may carry additional columns (e.g. the word counts).
+inline std::vector<std::string> load_words(const std::string& fp, size_t max_words = SIZE_MAX) {
+  std::ifstream file_stream(fp);
+  if (!file_stream.is_open()) {
+    throw std::runtime_error("Failed to open file: " + fp);
+  }
+
+  std::vector<std::string> words;
+  std::string line;
+  while (words.size() < max_words && std::getline(file_stream, line)) {
+    const size_t begin = line.find_first_not_of(" \t\r");
+    if (begin == std::string::npos)
+      continue;
+    const size_t end = line.find_first_of(" \t\r", begin);
+    words.push_back(line.substr(begin, end == std::string::npos ? std::string::npos : end - begin));
+  }
+  return words;
+}
+
+// File content hash
+// 64-bit FNV-1a over the file bytes, used to tell apart different versions of the data files.
+inline uint64_t hash_file(const std::string& fp) {
+  std::ifstream file_stream(fp, std::ios::binary);
+  if (!file_stream.is_open()) {
+    throw std::runtime_error("Failed to open file: " + fp);
+  }
+
+  uint64_t hash = 0xcbf29ce484222325ULL;
+  char buffer[1 << 16];
+  while (file_stream.read(buffer, sizeof(buffer)) || file_stream.gcount() > 0) {
+    for (std::streamsize i = 0; i < file_stream.gcount(); i++)
+      hash = (hash ^ static_cast<unsigned char>(buffer[i])) * 0x100000001b3ULL;
+  }
+  return hash;
+}
+
 } // phonemis::utilities::io
\ No newline at end of file
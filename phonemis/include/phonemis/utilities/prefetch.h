@@ -0,0 +1,22 @@
+#pragma once
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <xmmintrin.h>
+#endif
+
+namespace phonemis::utilities {
+
+// Software prefetch
+// Asks the CPU to start loading the cache line holding given address, without waiting for it.
+// Used to overlap the memory latencies of independent lookups. No-op on unsupported compilers.
+inline void prefetch(const void* address) {
+#if defined(__GNUC__) || defined(__clang__)
+  __builtin_prefetch(address);
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+  _mm_prefetch(static_cast<const char*>(address), _MM_HINT_T0);
+#else
+  (void)address;
+#endif
+}
+
+} // namespace phonemis::utilities
@@ -3,6 +3,7 @@
 #include <algorithm>
 #include <codecvt>
 #include <functional>
+#include <locale>
 #include <optional>
 #include <string>
 #include <string_view>
@@ -0,0 +1,133 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace phonemis::utilities {
+
+// ThreadPool class
+// A minimalistic pool of worker threads for data-parallel loops.
+// The calling thread always takes part in the work, so nested or concurrent
+// parallel_for calls cannot deadlock, even if all the workers are busy.
+class ThreadPool {
+public:
+  explicit ThreadPool(size_t no_threads = std::thread::hardware_concurrency()) {
+    // The calling thread is one of the executors, so we spawn one thread less
+    for (size_t i = 1; i < no_threads; i++)
+      workers_.emplace_back([this]() { work(); });
+  }
+
+  ~ThreadPool() {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stopping_ = true;
+    }
+    cv_.notify_all();
+    for (auto& worker : workers_)
+      worker.join();
+  }
+
+  ThreadPool(const ThreadPool&) = delete;
+  ThreadPool& operator=(const ThreadPool&) = delete;
+
+  // A process-wide pool, sized to the number of hardware threads
+  static ThreadPool& shared() {
+    static ThreadPool pool;
+    return pool;
+  }
+
+  // Number of threads executing the loops (including the calling one)
+  size_t size() const { return workers_.size() + 1; }
+
+  // Calls f(i) for each i in [0, n), distributing the calls among the threads.
+  // Returns once all the calls are finished. The first exception thrown by `f` is rethrown.
+  template <typename F>
+  void parallel_for(size_t n, F&& f) {
+    if (n == 0)
+      return;
+    if (n == 1 || workers_.empty()) {
+      for (size_t i = 0; i < n; i++)
+        f(i);
+      return;
+    }
+
+    // Loop state - shared with the helper tasks, which may outlive this call
+    // if they are picked up by the workers only after the loop has finished.
+    struct Loop {
+      std::function<void(size_t)> body;
+      size_t n;
+      std::atomic<size_t> next = 0;
+      std::atomic<size_t> done = 0;
+      std::mutex mutex;
+      std::condition_variable cv;
+      std::exception_ptr error = nullptr;
+
+      void run() {
+        for (size_t i = next++; i < n; i = next++) {
+          try {
+            body(i);
+          } catch (...) {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (!error) error = std::current_exception();
+          }
+          if (++done == n) {
+            std::lock_guard<std::mutex> lock(mutex);
+            cv.notify_all();
+          }
+        }
+      }
+    };
+
+    auto loop = std::make_shared<Loop>();
+    loop->body = std::forward<F>(f);
+    loop->n = n;
+
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      for (size_t i = 0; i < std::min(n - 1, workers_.size()); i++)
+        tasks_.emplace_back([loop]() { loop->run(); });
+    }
+    cv_.notify_all();
+
+    loop->run();
+
+    std::unique_lock<std::mutex> lock(loop->mutex);
+    loop->cv.wait(lock, [&loop]() { return loop->done == loop->n; });
+    if (loop->error)
+      std::rethrow_exception(loop->error);
+  }
+
+private:
+  // Worker thread main loop
+  void work() {
+    while (true) {
+      std::function<void()> task;
+      {
+        std::unique_lock<std::mutex> lock(mutex_);
+        cv_.wait(lock, [this]() { return stopping_ || !tasks_.empty(); });
+        if (stopping_ && tasks_.empty())
+          return;
+        task = std::move(tasks_.front());
+        tasks_.pop_front();
+      }
+      task();
+    }
+  }
+
+  std::vector<std::thread> workers_;
+  std::deque<std::function<void()>> tasks_;
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  bool stopping_ = false;
+};
+
+} // namespace phonemis::utilities
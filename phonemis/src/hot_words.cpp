@@ -0,0 +1,52 @@
+#include <phonemis/phonemizer/hot_words.h>
+#include <phonemis/utilities/flat_hash_map.h>
+#include <bit>
+#include <cstring>
+
+namespace phonemis::phonemizer {
+
+HotWords::HotWords(size_t capacity)
+  : slots_(capacity > 0 ? std::bit_ceil(capacity + capacity / 2) : 0), capacity_(capacity) {}
+
+bool HotWords::insert(std::string_view word, const Pronunciation& pronunciation) {
+  const auto& phonemes = pronunciation.phonemes;
+  if (size_ >= capacity_ || word.empty() || word.size() > kMaxWordSize || phonemes.size() > kMaxPhonemes)
+    return false;
+
+  const size_t mask = slots_.size() - 1;
+  for (size_t i = slot_index(word);; i = (i + 1) & mask) {
+    Slot& slot = slots_[i];
+    if (slot.word_size == word.size() && std::memcmp(slot.word, word.data(), word.size()) == 0)
+      return false;
+    if (slot.word_size != 0)
+      continue;
+
+    slot.word_size = static_cast<uint8_t>(word.size());
+    slot.no_phonemes = static_cast<uint8_t>(phonemes.size());
+    slot.info = pronunciation.info;
+    std::memcpy(slot.word, word.data(), word.size());
+    std::memcpy(slot.phonemes, phonemes.data(), phonemes.size() * sizeof(char32_t));
+    size_++;
+    return true;
+  }
+}
+
+std::optional<PronunciationRef> HotWords::find(std::string_view word) const {
+  if (size_ == 0 || word.empty() || word.size() > kMaxWordSize)
+    return std::nullopt;
+
+  const size_t mask = slots_.size() - 1;
+  for (size_t i = slot_index(word);; i = (i + 1) & mask) {
+    const Slot& slot = slots_[i];
+    if (slot.word_size == 0)
+      return std::nullopt;
+    if (slot.word_size == word.size() && std::memcmp(slot.word, word.data(), word.size()) == 0)
+      return PronunciationRef(std::u32string_view(slot.phonemes, slot.no_phonemes), slot.info);
+  }
+}
+
+size_t HotWords::slot_index(std::string_view word) const {
+  return utilities::hash_bytes(word.data(), word.size()) & (slots_.size() - 1);
+}
+
+} // namespace phonemis::phonemizer
@@ -2,11 +2,11 @@
 #include <phonemis/phonemizer/constants.h>
 #include <phonemis/phonemizer/stress.h>
 #include <phonemis/utilities/io_utils.h>
+#include <phonemis/utilities/prefetch.h>
 #include <phonemis/utilities/string_utils.h>
+#include <array>
 #include <filesystem>
 #include <fstream>
-#include <numeric>
-#include <regex>
 #include <stdexcept>
 
 #include <iostream>
@@ -15,7 +15,7 @@ namespace phonemis::phonemizer {
 
 using namespace utilities;
 
-Lexicon::Lexicon(Lang language, const std::string& dict_filepath)
+Lexicon::Lexicon(Lang language, const std::string& dict_filepath, const std::vector<std::string>& hot_words)
   : language_(language) {
   // Load the input JSON file
 	auto json_obj = io_utils::load_json(dict_filepath);
@@ -25,242 +25,502 @@ Lexicon::Lexicon(Lang language, const std::string& dict_filepath)
     const std::string text = item.key();
     const auto& phonemes = item.value();
 
+    // Derived entries are kept apart, since they are valid in a single context only (see stem)
+    if (phonemes.is_object()) {
+      const auto phonemes_it = phonemes.find(constants::lexicon::kPhonemesKey);
+      const auto derived_it = phonemes.find(constants::lexicon::kDerivedKey);
+      if (phonemes_it == phonemes.end() || !phonemes_it->is_string() ||
+          derived_it == phonemes.end() || !derived_it->is_string())
+        throw std::invalid_argument("Unexpected JSON structure in file " + dict_filepath);
+      if (derived_it->get<std::string>() == to_string(language))
+        derived_[text] = Pronunciation(string_utils::utf8_to_u32string(phonemes_it->get<std::string>()));
+      continue;
+    }
+
     if (!phonemes.is_string())
       throw std::invalid_argument("Unexpected JSON structure in file " + dict_filepath);
     
     // Convert the value to u32string and add the entry
-    auto phonemes_u32 = string_utils::utf8_to_u32string(phonemes.get<std::string>());
-    dict_[text] = phonemes_u32;
+    const Pronunciation pronunciation(string_utils::utf8_to_u32string(phonemes.get<std::string>()));
+    dict_[text] = pronunciation;
 
     // In order to make the vocab less case-sensitive, we expand it with 
     // additional entries: lowered and capitalized one if needed.
     auto text_lowered = string_utils::to_lower(text);
     auto text_capitalized = string_utils::capitalize(text);
     if (text.size() >= 2 && text == text_lowered && text != text_capitalized)
-      dict_[text_capitalized] = phonemes_u32;
+      dict_[text_capitalized] = pronunciation;
     else if (text.size() >= 2 && text == string_utils::capitalize(text_lowered))
-      dict_[text_lowered] = phonemes_u32;
+      dict_[text_lowered] = pronunciation;
+  }
+
+  // Build the filter of the known words
+  filter_ = utilities::BloomFilter(dict_.size(), constants::lexicon::kFilterBitsPerKey);
+  for (const auto& [text, pronunciation] : dict_)
+    filter_.insert(dict_.hash(text));
+
+  // Precompute single character phonemizations (used to spell words out)
+  for (const auto& [text, pronunciation] : dict_) {
+    if (text.size() == 1)
+      characters_[static_cast<unsigned char>(text[0])] = &pronunciation.phonemes;
+  }
+
+  // Index the syllabes of the fallback phonemization
+  std::vector<std::pair<std::string_view, std::u32string_view>> syllables;
+  for (const auto& [text, pronunciation] : dict_) {
+    if (text.size() <= static_cast<size_t>(constants::kMaxSyllabeLength))
+      syllables.emplace_back(text, pronunciation.phonemes);
   }
+  syllables_ = SyllableIndex(std::move(syllables));
+
+  build_hot_words(hot_words);
+}
+
+namespace {
+// Reusable per-thread buffers of the query path
+// They keep their capacity between the queries, so that the lookups do not allocate.
+struct QueryBuffers {
+  std::string lower;        // Lower-cased queried word
+  std::string stem;         // Candidate stem built from the word (for stems with modified endings)
+  std::string stem_lower;   // Lower-cased candidate stem
+};
+thread_local QueryBuffers buffers;
+
+// Equivalent of string_utils::is_alpha(string_utils::filter(word, pred)), without building the filtered string
+template <typename Pred>
+bool is_alpha_filtered(std::string_view word, Pred pred) {
+  return std::all_of(word.begin(), word.end(), [&pred](char c) { return pred(c) || std::isalpha(c); });
 }
 
-bool Lexicon::is_known(const std::string& word) const {
-  return dict_.contains(word) || dict_.contains(string_utils::to_lower(word)) ||
+// Special words
+// Words with tag or context dependent phonemization, keyed by their lower case form.
+enum class SpecialWord { A, AM, AN, I, BY, TO, IN, THE, VERSUS, USED, SOURCE };
+const FlatHashMap<std::string_view, SpecialWord> kSpecialWords = {
+  {"a", SpecialWord::A}, {"am", SpecialWord::AM}, {"an", SpecialWord::AN}, {"i", SpecialWord::I},
+  {"by", SpecialWord::BY}, {"to", SpecialWord::TO}, {"in", SpecialWord::IN}, {"the", SpecialWord::THE},
+  {"vs", SpecialWord::VERSUS}, {"vs.", SpecialWord::VERSUS},
+  {"used", SpecialWord::USED}, {"src", SpecialWord::SOURCE}
+};
+
+// Fixed pronunciations of the special words (with precomputed metadata)
+struct SpecialPronunciations {
+  Pronunciation a{U"ˈA"}, a_weak{U"ɐ"};
+  Pronunciation am_weak{U"ɐm"};
+  Pronunciation an{U"ɐn"};
+  Pronunciation i{std::u32string(1, constants::stress::kSecondary) + U"I"};
+  Pronunciation by{U"bˈI"};
+  Pronunciation to{U"tə"}, to_before_vowel{U"tʊ"};
+  Pronunciation in{U"ɪn"}, in_stressed{std::u32string(1, constants::stress::kPrimary) + U"ɪn"};
+  Pronunciation the{U"ðə"}, the_before_vowel{U"ði"};
+};
+
+// Fills the buffer with lower-cased word
+std::string_view lowerize(std::string_view word, std::string& buffer) {
+  buffer.assign(word);
+  string_utils::to_lower__(buffer);
+  return buffer;
+}
+
+// Fills the buffers with a stem made of the word's prefix and a new ending
+std::pair<std::string_view, std::string_view> make_stem(std::string_view word, std::string_view lower,
+                                                        size_t prefix_size, std::string_view ending) {
+  buffers.stem.assign(word.substr(0, prefix_size)).append(ending);
+  buffers.stem_lower.assign(lower.substr(0, prefix_size)).append(ending);
+  return {buffers.stem, buffers.stem_lower};
+}
+} // namespace
+
+void Lexicon::bind(tokenizer::Vocabulary& vocabulary) {
+  for (const auto& [text, pronunciation] : dict_)
+    vocabulary.intern(text);
+  for (const auto& [text, pronunciation] : derived_)
+    vocabulary.intern(text);
+
+  // Resolve the probes of every vocabulary word, including the ones interned by the other components
+  std::string lower;
+  bound_.assign(vocabulary.size(), BoundEntry());
+  for (tokenizer::WordId id = 0; id < vocabulary.size(); id++) {
+    const std::string_view word = vocabulary.word(id);
+    auto& entry = bound_[id];
+    entry.exact = find(word);
+    entry.lower = find(lowerize(word, lower));
+    entry.derived = derived_.find(word);
+    if (const auto* special_word = kSpecialWords.find(lower))
+      entry.special = static_cast<int>(*special_word);
+  }
+}
+
+void Lexicon::build_hot_words(const std::vector<std::string>& words) {
+  if (words.empty())
+    return;
+
+  // Only the words phonemized straight from the dictionary are admitted, since get_word
+  // resolves them with a plain lookup: known lower case words, other than the symbols,
+  // the dotted abbreviations and the special words.
+  hot_words_ = HotWords(words.size());
+  for (const auto& word : words) {
+    const Pronunciation* phonemes = find(word);
+    if (phonemes == nullptr || phonemes->empty() || word.size() < 2 ||
+        word.find('.') != std::string::npos || string_utils::to_lower(word) != word ||
+        kSpecialWords.contains(word) || derived_.contains(word))
+      continue;
+    hot_words_.insert(word, *phonemes);
+  }
+}
+
+std::optional<PronunciationRef> Lexicon::pronounce_hot(std::string_view word,
+                                                       tagger::Tag tag,
+                                                       std::optional<float> base_stress) const {
+  auto phonemes = hot_words_.find(word);
+  if (!phonemes.has_value() || tag == tagger::Tag::NNP && !phonemes->info().has_primary)
+    return std::nullopt;
+
+  if (base_stress.has_value() && changes_stress(phonemes->info(), base_stress.value()))
+    return apply_stress(phonemes->to_pronunciation(), base_stress.value());
+  return phonemes;
+}
+
+bool Lexicon::is_known(std::string_view word) const {
+  thread_local std::string lower;
+  return is_known(word, lowerize(word, lower), nullptr);
+}
+
+bool Lexicon::is_known(std::string_view word, std::string_view lower, const BoundEntry* bound) const {
+  return find_exact(word, bound) != nullptr || word != lower && find_lower(lower, bound) != nullptr ||
          word.size() == 1 && (std::isalpha(word[0]) || constants::alphabet::kSymbols.contains(word[0]));
 }
 
-std::u32string Lexicon::get(const std::string& word, 
-                            const tagger::Tag& tag,
-                            std::optional<float> base_stress,
-                            std::optional<bool> vowel_next) {
-  std::optional<float> stress = word == string_utils::to_lower(word) ? std::nullopt :
-                                word == string_utils::to_upper(word) ? 
-                                  std::make_optional(2.F) : std::make_optional(0.5F);
+const Pronunciation* Lexicon::find(std::string_view word) const {
+  return find(word, dict_.hash(word));
+}
+
+const Pronunciation* Lexicon::find(std::string_view word, size_t hash) const {
+  return filter_.may_contain(hash) ? dict_.find(word, hash) : nullptr;
+}
+
+void Lexicon::find_batch(std::span<const std::string_view> words,
+                         std::span<const Pronunciation*> results,
+                         std::span<const tokenizer::WordId> ids) const {
+  // Per-thread buffers, kept between the batches
+  struct BatchBuffers {
+    std::string lowers;                             // Lower-cased words, concatenated
+    std::vector<std::pair<size_t, size_t>> hashes;  // Hashes of the exact and lower case probes
+  };
+  thread_local BatchBuffers batch;
+  batch.lowers.clear();
+  batch.hashes.clear();
+
+  // Words with a bound id need no hashing
+  auto bound_entry = [&](size_t i) -> const BoundEntry* {
+    return i < ids.size() && ids[i] < bound_.size() ? &bound_[ids[i]] : nullptr;
+  };
+
+  // Stage 1 - lower-case and hash the words, prefetch the filter blocks and the first probed dictionary
+  // group of the exact probe (or the bound entries)
+  for (size_t i = 0; i < words.size(); i++) {
+    const std::string_view word = words[i];
+    batch.lowers.append(word);
+    if (const auto* entry = bound_entry(i)) {
+      prefetch(entry);
+      batch.hashes.emplace_back(0, 0);
+      continue;
+    }
+
+    std::transform(batch.lowers.end() - word.size(), batch.lowers.end(), batch.lowers.end() - word.size(),
+                   [](auto c) { return std::tolower(c); });
+    const std::string_view lower(batch.lowers.data() + batch.lowers.size() - word.size(), word.size());
+
+    const size_t hash = dict_.hash(word);
+    const size_t lower_hash = word != lower ? dict_.hash(lower) : hash;
+    filter_.prefetch(hash);
+    dict_.prefetch(hash);
+    if (lower_hash != hash)
+      filter_.prefetch(lower_hash);
+    batch.hashes.emplace_back(hash, lower_hash);
+  }
+
+  // Stage 2 - resolve the probes passing the filter, and prefetch the found phonemes.
+  // The lookups of subsequent words do not depend on each other, so their misses overlap.
+  for (size_t i = 0, offset = 0; i < words.size(); offset += words[i].size(), i++) {
+    const std::string_view word = words[i];
+    const std::string_view lower(batch.lowers.data() + offset, word.size());   // Not lowered for the bound words
+    const auto [hash, lower_hash] = batch.hashes[i];
+
+    const Pronunciation* phonemes = nullptr;
+    if (const auto* entry = bound_entry(i))
+      phonemes = entry->exact != nullptr ? entry->exact : entry->lower;
+    else {
+      phonemes = find(word, hash);
+      if (phonemes == nullptr && word != lower)
+        phonemes = find(lower, lower_hash);
+    }
+    if (phonemes != nullptr)
+      prefetch(phonemes->phonemes.data());
+    results[i] = phonemes;
+  }
+}
+
+PronunciationRef Lexicon::pronounce_ref(std::string_view word,
+                                        tagger::Tag tag,
+                                        std::optional<float> base_stress,
+                                        std::optional<bool> vowel_next,
+                                        std::optional<tokenizer::WordId> id) const {
+  if (!hot_words_.empty()) {
+    if (auto phonemes = pronounce_hot(word, tag, base_stress))
+      return std::move(*phonemes);
+  }
+
+  const std::string_view lower = lowerize(word, buffers.lower);
+
+  // The probes of the word itself are resolved by its id, if bound
+  const BoundEntry* bound = id.has_value() && *id < bound_.size() ? &bound_[*id] : nullptr;
+  const bool is_upper = std::none_of(word.begin(), word.end(),
+                                     [](char c) { return std::islower(static_cast<unsigned char>(c)); });
+  std::optional<float> stress = word == lower ? std::nullopt :
+                                is_upper ? std::make_optional(2.F) : std::make_optional(0.5F);
   
   // Phonemize
-  std::u32string phonemes = get_word(word, tag, stress, vowel_next);
+  PronunciationRef phonemes = get_word(word, lower, tag, stress, vowel_next, bound);
 
   // Apply base stress
   // TODO: consider dealing with some trailing currency characters here
-  if (!phonemes.empty() && base_stress.has_value())
-    return apply_stress(phonemes, base_stress.value());
+  if (!phonemes.empty() && base_stress.has_value() && changes_stress(phonemes.info(), base_stress.value()))
+    return apply_stress(std::move(phonemes).to_pronunciation(), base_stress.value());
   
   return phonemes;
 }
 
-std::u32string Lexicon::get_word(const std::string& word,
-                                 const tagger::Tag& tag,
-                                 std::optional<float> stress,
-                                 std::optional<bool> vowel_next) const {
+std::u32string Lexicon::derive(std::string_view word) const {
+  const std::string_view lower = lowerize(word, buffers.lower);
+  if (word != lower || is_known(word, lower, nullptr))
+    return U"";
+  return stem(word, lower, tagger::Tag::NONE, std::nullopt).phonemes;
+}
+
+PronunciationRef Lexicon::get_word(std::string_view word,
+                                    std::string_view lower,
+                                    tagger::Tag tag,
+                                    std::optional<float> stress,
+                                    std::optional<bool> vowel_next,
+                                    const BoundEntry* bound) const {
   // Lookup for special words
-  std::u32string phonemes = lookup_special(word, tag, stress, vowel_next);
+  PronunciationRef phonemes = lookup_special(word, lower, tag, stress, vowel_next, bound);
   if (!phonemes.empty())
     return phonemes;
+
+  // Materialized inflections
+  // Derived entries are never known words, so they replace the whole suffix-based path
+  // (only in the context they were computed for - lower case word, no stress, not NNP).
+  if (!stress.has_value() && tag != tagger::Tag::NNP && !derived_.empty()) {
+    if (const auto* derived = bound != nullptr ? bound->derived : derived_.find(word))
+      return PronunciationRef(derived);
+  }
   
   // TODO: add unicode normalization
-  std::string used_word = word;
-  std::string lower = string_utils::to_lower(word);
+  // Words in upper or capitalized case are lowered if the lower case form is known.
+  // The suffix-based phonemization of the original word is kept, since it is reused below
+  // whenever the word is not lowered.
+  std::string_view used_word = word;
+  std::optional<Pronunciation> word_stem = std::nullopt;
+  auto is_lower = [](char c) { return std::islower(static_cast<unsigned char>(c)); };
   if (word.size() > 1 &&
-      string_utils::is_alpha(string_utils::filter(word, [](char c) -> bool { return c != '\''; })) &&
+      is_alpha_filtered(word, [](char c) -> bool { return c != '\''; }) &&
       word != lower &&
-      (tag != "NNP" || word.size() > 7) &&
-      !dict_.contains(word) &&
-      (word == string_utils::to_upper(word) || word.substr(1) == string_utils::to_lower(word.substr(1))) &&
-      (dict_.contains(lower) || stem_s(word, tag, stress) != U"" ||
-        stem_ed(word, tag, stress) != U"" || stem_ing(word, tag, stress) != U""))
+      (tag != tagger::Tag::NNP || word.size() > 7) &&
+      find_exact(word, bound) == nullptr &&
+      (std::none_of(word.begin(), word.end(), is_lower) || word.substr(1) == lower.substr(1)) &&
+      (find_lower(lower, bound) != nullptr || !(word_stem = stem(word, lower, tag, stress))->empty()))
     used_word = lower;
+
+  // Once lowered, the entry of the used word is the lower case entry of the word
+  const BoundEntry lowered_bound = bound != nullptr ? BoundEntry{bound->lower, bound->lower} : BoundEntry();
+  const BoundEntry* used_bound = bound != nullptr && used_word != word ? &lowered_bound : bound;
   
-  if (is_known(used_word))
-    return lookup(word, tag, stress);
-  if (string_utils::ends_with(used_word, "s'") && is_known(used_word.substr(0, used_word.size() - 2) + "'s"))
-    return lookup(used_word.substr(0, used_word.size() - 2) + "'s", tag, stress);
-  if (string_utils::ends_with(used_word, "'") && is_known(used_word.substr(0, used_word.size() - 1)))
-    return lookup(used_word.substr(0, used_word.size() - 1), tag, stress);
-  
-  for (auto stem_f : {&Lexicon::stem_s, &Lexicon::stem_ed}) {
-    phonemes = (this->*stem_f)(used_word, tag, stress);
-    if (!phonemes.empty()) 
-      return phonemes;
+  if (is_known(used_word, lower, used_bound))
+    return lookup(word, lower, tag, stress, bound);
+  if (string_utils::ends_with(used_word, "s'")) {
+    const auto [stem, stem_lower] = make_stem(used_word, lower, used_word.size() - 2, "'s");
+    if (is_known(stem, stem_lower, nullptr))
+      return lookup(stem, stem_lower, tag, stress);
   }
-
-  phonemes = stem_ing(used_word, tag, stress.has_value() ? stress.value() : 0.5F);
+  if (string_utils::ends_with(used_word, "'") && is_known(used_word.substr(0, used_word.size() - 1), lower.substr(0, lower.size() - 1), nullptr))
+    return lookup(used_word.substr(0, used_word.size() - 1), lower.substr(0, lower.size() - 1), tag, stress);
+  
+  phonemes = used_word == word && word_stem.has_value() ? std::move(*word_stem) : stem(used_word, lower, tag, stress);
   if (!phonemes.empty())
     return phonemes;
   
-  if (used_word != lower && 
-      dict_.contains(lower))
-    return dict_.at(lower);
+  if (used_word != lower)
+    if (const auto* lower_phonemes = find_lower(lower, bound))
+      return PronunciationRef(lower_phonemes);
   
-  return U"";
+  return {};
 }
 
-std::u32string Lexicon::stem_s(const std::string& word,
-                               const tagger::Tag& tag,
-                               std::optional<float> stress) const {
-  std::string stem;
+Lexicon::SuffixAnalysis Lexicon::analyze_suffix(std::string_view word, std::string_view lower) const {
+  // Candidate stem - the word's prefix of given size with an optional new ending
+  struct Candidate {
+    size_t prefix_size;
+    std::string_view ending;
+  };
+  std::array<Candidate, 3> candidates;
+  size_t no_candidates = 0;
+
+  // Classify the ending - the suffixes are mutually exclusive
+  const size_t size = word.size();
+  Suffix suffix = Suffix::NONE;
+  if (size >= 3 && word.back() == 's') {
+    suffix = Suffix::S;
+    if (!string_utils::ends_with(word, "ss"))
+      candidates[no_candidates++] = {size - 1, ""};
+    if (string_utils::ends_with(word, "'s") ||
+        size > 4 && string_utils::ends_with(word, "es") && !string_utils::ends_with(word, "ies"))
+      candidates[no_candidates++] = {size - 2, ""};
+    if (size > 4 && string_utils::ends_with(word, "ies"))
+      candidates[no_candidates++] = {size - 3, "y"};
+  }
+  else if (size >= 4 && word.back() == 'd') {
+    suffix = Suffix::ED;
+    if (!string_utils::ends_with(word, "dd"))
+      candidates[no_candidates++] = {size - 1, ""};
+    if (size > 4 && string_utils::ends_with(word, "ed") && !string_utils::ends_with(word, "eed"))
+      candidates[no_candidates++] = {size - 2, ""};
+  }
+  else if (size >= 5 && string_utils::ends_with(word, "ing")) {
+    suffix = Suffix::ING;
+    // Doubled consonant (example: stopping) or -cking ending
+    static constexpr std::string_view doubled_consonants = "bcdgklmnprstvxz";
+    const bool is_doubled = word[size - 5] == word[size - 4] &&
+                            doubled_consonants.find(word[size - 4]) != std::string_view::npos;
+    if (size > 5)
+      candidates[no_candidates++] = {size - 3, ""};
+    candidates[no_candidates++] = {size - 3, "e"};
+    if (size > 5 && (is_doubled || string_utils::ends_with(word, "cking")))
+      candidates[no_candidates++] = {size - 4, ""};
+  }
 
-  if (word.size() < 3 || word.back() != 's')
-    return U"";
-  else if (!string_utils::ends_with(word, "ss") && is_known(word.substr(0, word.size() - 1)))
-    stem = word.substr(0, word.size() - 1);
-  else if ((string_utils::ends_with(word, "'s") || 
-            word.size() > 4 && string_utils::ends_with(word, "es") && !string_utils::ends_with(word, "ies")) &&
-            is_known(word.substr(0, word.size() - 2)))
-    stem = word.substr(0, word.size() - 2);
-  else if (word.size() > 4 && string_utils::ends_with(word, "ies") &&
-           is_known(word.substr(0, word.size() - 3) + "y"))
-    stem = word.substr(0, word.size() - 3) + "y";
-  else
-    return U"";
+  // Probe the candidates, the first known one wins
+  for (size_t i = 0; i < no_candidates; ++i) {
+    const auto [prefix_size, ending] = candidates[i];
+    std::string_view stem = word.substr(0, prefix_size), stem_lower = lower.substr(0, prefix_size);
+    if (!ending.empty())
+      std::tie(stem, stem_lower) = make_stem(word, lower, prefix_size, ending);
+    if (is_known(stem, stem_lower, nullptr))
+      return {suffix, stem, stem_lower};
+  }
 
-  auto phonemes = lookup(stem, tag, stress);
+  return {};
+}
 
+Pronunciation Lexicon::stem(std::string_view word,
+                            std::string_view lower,
+                            tagger::Tag tag,
+                            std::optional<float> stress) const {
+  const auto analysis = analyze_suffix(word, lower);
+  if (analysis.suffix == Suffix::NONE)
+    return {};
+
+  // Words ending with -ing are stressed by default
+  if (analysis.suffix == Suffix::ING && !stress.has_value())
+    stress = 0.5F;
+  
+  auto phonemes = lookup(analysis.stem, analysis.stem_lower, tag, stress);
   if (phonemes.empty())
-    return U"";
+    return {};
+
+  // The suffix is appended to a copy of the stem's phonemes
+  switch (analysis.suffix) {
+    case Suffix::S: return add_s(std::move(phonemes).to_pronunciation());
+    case Suffix::ED: return add_ed(std::move(phonemes).to_pronunciation());
+    default: return add_ing(std::move(phonemes).to_pronunciation());
+  }
+}
 
+Pronunciation Lexicon::add_s(Pronunciation stem) const {
   // Adjust phonemization according to selected language rules.
   // https://en.wiktionary.org/wiki/-s
-  static const std::u32string hard_s_suffixes = U"ptkfθ";
-  static const std::u32string soft_s_suffixes = U"szʃʒʧʤ";
-  if (hard_s_suffixes.find(phonemes.back()) != std::u32string::npos)
-    return phonemes + U"s";
-  if (soft_s_suffixes.find(phonemes.back()) != std::u32string::npos)
-    return phonemes + (language_ == Lang::EN_GB ? U"ɪ" : U"ᵻ") + U"z";
+  if (stem.info.last & ending::kHardS)
+    return std::move(stem.append(U"s"));
+  if (stem.info.last & ending::kSibilant)
+    return std::move(stem.append(language_ == Lang::EN_GB ? U"ɪz" : U"ᵻz"));
   
-  return phonemes + U"z";
+  return std::move(stem.append(U"z"));
 }
 
-std::u32string Lexicon::stem_ed(const std::string& word,
-                                const tagger::Tag& tag,
-                                std::optional<float> stress) const {
-  std::string stem;
-
-  if (word.size() < 4 || word.back() != 'd')
-    return U"";
-  else if (!string_utils::ends_with(word, "dd") && is_known(word.substr(0, word.size() - 1)))
-    stem = word.substr(0, word.size() - 1);
-  else if (word.size() > 4 && string_utils::ends_with(word, "ed") &&
-           !string_utils::ends_with(word, "eed") && is_known(word.substr(0, word.size() - 2)))
-    stem = word.substr(0, word.size() - 2);
-  else
-    return U"";
-  
-  auto phonemes = lookup(stem, tag, stress);
-
-  if (phonemes.empty())
-    return U"";
-
+Pronunciation Lexicon::add_ed(Pronunciation stem) const {
   // Adjust phonemization according to selected language rules.
   // https://en.wiktionary.org/wiki/-ed
-  static const std::u32string soft_d_suffixes = U"pkfθʃsʧ";
-  if (soft_d_suffixes.find(phonemes.back()) != std::u32string::npos)
-    return phonemes + U"t";
-  if (phonemes.back() == U'd')
-    return phonemes + (language_ == Lang::EN_GB ? U"ɪ" : U"ᵻ") + U"d";
-  if (phonemes.back() != U't')
-    return phonemes + U"d";
-  if (language_ == Lang::EN_GB || phonemes.size() < 2)
-    return phonemes + U"ɪd";
-  if (constants::language::kUSTaus.find(phonemes[phonemes.size() - 2]) != std::u32string::npos)
-    return phonemes.substr(0, phonemes.size() - 1) + U"ɾᵻd";
+  if (stem.info.last & ending::kVoiceless)
+    return std::move(stem.append(U"t"));
+  if (stem.info.last & ending::kD)
+    return std::move(stem.append(language_ == Lang::EN_GB ? U"ɪd" : U"ᵻd"));
+  if (!(stem.info.last & ending::kT))
+    return std::move(stem.append(U"d"));
+  if (language_ == Lang::EN_GB || stem.phonemes.size() < 2)
+    return std::move(stem.append(U"ɪd"));
+  if (stem.info.last & ending::kTauT)
+    return std::move(stem.append(U"ɾᵻd", 1));
   
-  return phonemes + U"ᵻd";
+  return std::move(stem.append(U"ᵻd"));
 }
 
-std::u32string Lexicon::stem_ing(const std::string& word,
-                                 const tagger::Tag& tag,
-                                 std::optional<float> stress) const {
-  std::string stem;
-
-  static const std::regex ing_pattern("([bcdgklmnprstvxz])\\1ing$|cking$");
-
-  if (word.size() < 5 || !string_utils::ends_with(word, "ing"))
-    return U"";
-  else if (word.size() > 5 && is_known(word.substr(0, word.size() - 3)))
-    stem = word.substr(0, word.size() - 3);
-  else if (is_known(word.substr(0, word.size() - 3) + "e"))
-    stem = word.substr(0, word.size() - 3) + "e";
-  else if (word.size() > 5 && std::regex_search(word, ing_pattern) &&
-           is_known(word.substr(0, word.size() - 4)))
-    stem = word.substr(0, word.size() - 4);
-  else
-    return U"";
-  
-  auto phonemes = lookup(stem, tag, stress);
-
-  if (phonemes.empty())
-    return U"";
-  
+Pronunciation Lexicon::add_ing(Pronunciation stem) const {
   // Adjust phonemization according to selected language rules.
   // https://en.wiktionary.org/wiki/-ing
-  if (language_ == Lang::EN_GB && (phonemes.back() == U'ə' || phonemes.back() == U'ː'))
-    return U""; // TODO: fix this
-  if (phonemes.size() > 1 && phonemes.back() == U't' &&
-      constants::language::kUSTaus.find(phonemes[phonemes.size() - 2]) != std::u32string::npos)
-    return phonemes.substr(0, phonemes.size() - 1) + U"ɾɪŋ";
+  if (language_ == Lang::EN_GB && (stem.info.last & ending::kLong))
+    return {}; // TODO: fix this
+  if (stem.info.last & ending::kTauT)
+    return std::move(stem.append(U"ɾɪŋ", 1));
   
-  return phonemes + U"ɪŋ";
+  return std::move(stem.append(U"ɪŋ"));
 }
 
-std::u32string Lexicon::lookup(const std::string& word,
-                               const tagger::Tag& tag,
-                               std::optional<float> stress) const {
+PronunciationRef Lexicon::lookup(std::string_view word,
+                                 std::string_view lower,
+                                 tagger::Tag tag,
+                                 std::optional<float> stress,
+                                 const BoundEntry* bound) const {
   // Lookup with both exact and lower case
-  std::u32string phonemes = dict_.contains(word) ? dict_.at(word) :
-                            dict_.contains(string_utils::to_lower(word)) 
-                              ? dict_.at(string_utils::to_lower(word)) : U"";
+  const Pronunciation* phonemes = find_exact(word, bound);
+  if (phonemes == nullptr && word != lower)
+    phonemes = find_lower(lower, bound);
   
-  bool is_nnp = tag == "NNP";
-  bool has_primary_stress = phonemes.find(constants::stress::kPrimary) != std::u32string::npos;
+  bool is_nnp = tag == tagger::Tag::NNP;
+  bool has_phonemes = phonemes != nullptr && !phonemes->empty();
+  bool has_primary_stress = has_phonemes && phonemes->info.has_primary;
 
   // Special case - unknown words & NNP (proper nouns)
   // Since proper noun names could be very unique and not present
   // in the dict, we try to manually resolve them.
   // Note that we also treat unknown words like NNPs.
-  if (phonemes.empty() || is_nnp && !has_primary_stress) {
+  if (!has_phonemes || is_nnp && !has_primary_stress) {
     auto phonemes_nnp = lookup_nnp(word);
     if (!phonemes_nnp.empty()) return phonemes_nnp;
-    else return phonemes;
+    else return PronunciationRef(has_phonemes ? phonemes : nullptr);
   }
 
-  return stress.has_value() ? apply_stress(phonemes, stress.value()) : phonemes;
+  if (stress.has_value() && changes_stress(phonemes->info, stress.value()))
+    return apply_stress(*phonemes, stress.value());
+  return PronunciationRef(phonemes);
 }
 
-std::u32string Lexicon::lookup_nnp(const std::string& word) const {
-  // First, filter all non-alpha characters
-  std::string word_alpha = string_utils::filter(word, [](char c) -> bool { return std::isalpha(c); });
-  size_t no_alphas = word_alpha.size();
-
+Pronunciation Lexicon::lookup_nnp(std::string_view word) const {
   // To handle a most likely unique word, we try to phonemize it letter by letter
+  // First, filter all non-alpha characters (as string_utils::filter does)
   std::u32string phonemes;
-  phonemes.reserve(no_alphas);
-  for (char c : word_alpha) {
-    if (!dict_.contains(std::string(1, c)))
-      return U"";
+  phonemes.reserve(word.size());
+  for (char c : word) {
+    if (std::isalpha(c))
+      continue;
+
+    const auto* letter_phonemes = characters_[static_cast<unsigned char>(c)];
+    if (letter_phonemes == nullptr)
+      return {};
     
-    phonemes += dict_.at(std::string(1, c));
+    phonemes += *letter_phonemes;
   }
 
-  phonemes = apply_stress(phonemes, 1.F);
+  phonemes = apply_stress(Pronunciation(std::move(phonemes)), 1.F).phonemes;
 
   // Reorganize stress characters
   // We split the string according to the secondary stress character's last position.
@@ -270,69 +530,116 @@ std::u32string Lexicon::lookup_nnp(const std::string& word) const {
   std::u32string second_part = has_secondary ? phonemes.substr(last_ssc + 1) : phonemes;
 
   if (first_part.empty() && second_part.empty())
-    return U"";
+    return {};
 
   // Join and return
-  return first_part + std::u32string(1, constants::stress::kPrimary) + second_part;
+  return Pronunciation(first_part + std::u32string(1, constants::stress::kPrimary) + second_part);
 }
 
-std::u32string 
-Lexicon::lookup_special(const std::string& word,
-                        const tagger::Tag& tag,
+PronunciationRef 
+Lexicon::lookup_special(std::string_view word,
+                        std::string_view lower,
+                        tagger::Tag tag,
                         std::optional<float> stress,
-                        std::optional<bool> vowel_next) const {
+                        std::optional<bool> vowel_next,
+                        const BoundEntry* bound) const {
   bool is_single_char = word.size() == 1;
-  bool is_add_symbol = is_single_char && constants::alphabet::kAddSymbols.contains(word[0]);
-  bool is_other_symbol = is_single_char && constants::alphabet::kSymbols.contains(word[0]);
-
-  std::string word_stripped = string_utils::strip(word, std::make_optional('.'));
-  std::string word_without_dots = string_utils::filter(word, [](char c) -> bool { return c != '.'; });
-  std::vector<std::string> word_splitted = string_utils::split(word_stripped, '.');
-  size_t max_subword_size = 
-    std::accumulate(word_splitted.begin(), word_splitted.end(), 0LL, 
-      [](size_t m, const auto& str) { return std::max(m, str.size()); });
-  
-  
-  if (tag == "ADD" && is_add_symbol)
-    return lookup(constants::alphabet::kAddSymbols.at(word[0]), {""}, {-0.5F});
-  else if (is_other_symbol)
-    return lookup(constants::alphabet::kSymbols.at(word[0]), {""}, {});
-  else if (word_stripped.find('.') != std::string::npos &&
-           string_utils::is_alpha(word_without_dots) && 
-           max_subword_size < 3)
-    return lookup_nnp(word);
-  else if (is_single_char && (word[0] == 'a' || word[0] == 'A'))
-    return tag == "DT" ? U"ɐ" : U"ˈA";
-  else if (word == "am" || word == "Am" || word == "AM") {
-    if (string_utils::starts_with(tag, "NN"))
+
+  // Symbols
+  if (is_single_char && tag == tagger::Tag::ADD) {
+    if (const auto* name = constants::alphabet::kAddSymbols.find(word[0]))
+      return lookup(*name, *name, tagger::Tag::NONE, {-0.5F});
+  }
+  if (is_single_char) {
+    if (const auto* name = constants::alphabet::kSymbols.find(word[0]))
+      return lookup(*name, *name, tagger::Tag::NONE, {});
+  }
+
+  // Dotted abbreviations (example: U.S.A.)
+  // The subwords are only examined when the word has the right shape.
+  std::string_view word_stripped = string_utils::strip(word, std::make_optional('.'));
+  if (word_stripped.find('.') != std::string_view::npos &&
+      is_alpha_filtered(word, [](char c) -> bool { return c != '.'; })) {
+    size_t max_subword_size = 0;
+    for (size_t begin = 0, end; begin <= word_stripped.size(); begin = end + 1) {
+      end = std::min(word_stripped.find('.', begin), word_stripped.size());
+      max_subword_size = std::max(max_subword_size, end - begin);
+    }
+    if (max_subword_size < 3)
       return lookup_nnp(word);
-    if (!vowel_next.has_value() || word != "am" || stress.has_value() && stress.value() > 0)
-      return dict_.at("am");
-    else
-      return U"ɐm";
   }
-  else if (word == "an" || word == "An" || word == "AN")
-    return word == "AN" && string_utils::starts_with(tag, "NN") ? lookup_nnp(word) : U"ɐn";
-  else if (is_single_char && word[0] == 'I' && tag == "PRP")
-    return std::u32string(1, constants::stress::kSecondary) + U"I";
-  else if ((word == "by" || word == "By" || word == "BY") && tag.parent_tag() == "ADV")
-    return U"bˈI";
-  else if (word == "to" || word == "To" || word == "TO" && (tag == "TO" || tag == "IN"))
-    return !vowel_next.has_value() ? dict_.at("to") :
-           vowel_next.value() ? U"tʊ" : U"tə";
-  else if (word == "in" || word == "In" || word == "IN" && tag != "NNP")
-    return (!vowel_next.has_value() || tag != "IN" ? std::u32string(1, constants::stress::kPrimary) : U"") + U"ɪn";
-  else if (word == "the" || word == "The" || word == "THE" && tag == "DT")
-    return vowel_next.has_value() && vowel_next.value() ? U"ði" : U"ðə";
-  else if (std::regex_match(word, std::regex(R"(vs\.?$)", std::regex_constants::icase)))
-    return lookup("versus", {""}, {});
-  else if (word == "used" || word == "Used" || word == "USED")
-    return dict_.at(word);
-  else if (string_utils::to_lower(word) == "src")
-    return dict_.at("source");
+
+  // Special words - dispatched with a single, case-insensitive probe (resolved by the id if known)
+  SpecialWord special_word;
+  if (bound != nullptr) {
+    if (bound->special < 0)
+      return {};
+    special_word = static_cast<SpecialWord>(bound->special);
+  }
+  else {
+    const auto* special = kSpecialWords.find(lower);
+    if (special == nullptr)
+      return {};
+    special_word = *special;
+  }
+
+  // Most of the special words are recognized only in lower, capitalized or upper case
+  const bool is_upper = std::none_of(word.begin(), word.end(),
+                                     [](char c) { return std::islower(static_cast<unsigned char>(c)); });
+  const bool is_capitalized = std::isupper(static_cast<unsigned char>(word[0])) && word.substr(1) == lower.substr(1);
+  const bool is_common_case = word == lower || is_capitalized || is_upper;
+  static const SpecialPronunciations kSpecial;
+
+  switch (special_word) {
+    case SpecialWord::A:
+      return PronunciationRef(tag == tagger::Tag::DT ? &kSpecial.a_weak : &kSpecial.a);
+    case SpecialWord::AM:
+      if (!is_common_case)
+        break;
+      if (tag.is(tagger::TagCategory::NOUN))
+        return lookup_nnp(word);
+      if (!vowel_next.has_value() || word != "am" || stress.has_value() && stress.value() > 0)
+        return PronunciationRef(&dict_.at("am"));
+      return PronunciationRef(&kSpecial.am_weak);
+    case SpecialWord::AN:
+      if (!is_common_case)
+        break;
+      if (word == "AN" && tag.is(tagger::TagCategory::NOUN))
+        return lookup_nnp(word);
+      return PronunciationRef(&kSpecial.an);
+    case SpecialWord::I:
+      if (word[0] == 'I' && tag == tagger::Tag::PRP)
+        return PronunciationRef(&kSpecial.i);
+      break;
+    case SpecialWord::BY:
+      if (is_common_case && tag.parent_tag() == tagger::Tag::ADV)
+        return PronunciationRef(&kSpecial.by);
+      break;
+    case SpecialWord::TO:
+      if (word == lower || is_capitalized || is_upper && (tag == tagger::Tag::TO || tag == tagger::Tag::IN))
+        return PronunciationRef(!vowel_next.has_value() ? &dict_.at("to") :
+                                vowel_next.value() ? &kSpecial.to_before_vowel : &kSpecial.to);
+      break;
+    case SpecialWord::IN:
+      if (word == lower || is_capitalized || is_upper && tag != tagger::Tag::NNP)
+        return PronunciationRef(!vowel_next.has_value() || tag != tagger::Tag::IN ? &kSpecial.in_stressed : &kSpecial.in);
+      break;
+    case SpecialWord::THE:
+      if (word == lower || is_capitalized || is_upper && tag == tagger::Tag::DT)
+        return PronunciationRef(vowel_next.has_value() && vowel_next.value() ? &kSpecial.the_before_vowel : &kSpecial.the);
+      break;
+    case SpecialWord::VERSUS:
+      return lookup("versus", "versus", tagger::Tag::NONE, {});
+    case SpecialWord::USED:
+      if (is_common_case)
+        return PronunciationRef(&dict_.at(word));
+      break;
+    case SpecialWord::SOURCE:
+      return PronunciationRef(&dict_.at("source"));
+  }
   
   // If the word is not a special case, return no phonemes
-  return U"";
+  return {};
 }
 
 } // namespace phonemis::phonemizer
\ No newline at end of file
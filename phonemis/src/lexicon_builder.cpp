@@ -0,0 +1,44 @@
+#include <phonemis/phonemizer/lexicon_builder.h>
+#include <phonemis/phonemizer/constants.h>
+#include <phonemis/phonemizer/lexicon.h>
+#include <phonemis/utilities/io_utils.h>
+#include <phonemis/utilities/string_utils.h>
+#include <fstream>
+#include <stdexcept>
+
+namespace phonemis::phonemizer {
+
+using namespace utilities;
+
+size_t materialize_inflections(Lang language,
+                               const std::string& dict_filepath,
+                               const std::vector<std::string>& words,
+                               const std::string& output_filepath) {
+  auto json_obj = io_utils::load_json(dict_filepath);
+  Lexicon lexicon(language, dict_filepath);
+
+  size_t no_derived = 0;
+  for (const auto& word : words) {
+    if (json_obj.contains(word))
+      continue;
+
+    const auto phonemes = lexicon.derive(word);
+    if (phonemes.empty())
+      continue;
+    
+    json_obj[word] = {
+      {constants::lexicon::kPhonemesKey, string_utils::u32string_to_utf8(phonemes)},
+      {constants::lexicon::kDerivedKey, std::string(to_string(language))}
+    };
+    no_derived++;
+  }
+
+  std::ofstream file_stream(output_filepath);
+  if (!file_stream.is_open()) {
+    throw std::runtime_error("Failed to open file: " + output_filepath);
+  }
+  file_stream << json_obj.dump(2);
+  return no_derived;
+}
+
+} // namespace phonemis::phonemizer
@@ -40,21 +40,23 @@ std::string join(const std::vector<std::string>& vec, const std::string& delimit
 // Helper function - get sorted keys for large cardinals
 const std::vector<int64_t>& get_sorted_large_keys() {
   // Optimize by creating and sorting array only once
-  static std::vector<int64_t> keys;
-  if (keys.empty()) {
+  // (in the static's initializer, which is thread-safe)
+  static const std::vector<int64_t> keys = [] {
+    std::vector<int64_t> sorted_keys;
     for (const auto& pair : constants::kLargeCardinals) {
-      keys.push_back(pair.first);
+      sorted_keys.push_back(pair.first);
     }
-    std::sort(keys.rbegin(), keys.rend());
-  }
+    std::sort(sorted_keys.rbegin(), sorted_keys.rend());
+    return sorted_keys;
+  }();
 
   return keys;
 }
 
 // Helper function - get ordinal suffix word
 std::string get_ordinal_suffix_word(const std::string& word) {
-  if (constants::kOrdinals.count(word)) {
-    return constants::kOrdinals.at(word);
+  if (const auto* ordinal = constants::kOrdinals.find(word)) {
+    return *ordinal;
   }
   if (!word.empty() && word.back() == 'y') {
     return word.substr(0, word.length() - 1) + "ieth";
@@ -73,8 +75,8 @@ std::string to_cardinal_int(long long value) {
   }
 
   // Direct lookup
-  if (constants::kCardinals.count(static_cast<int>(value))) {
-    return constants::kCardinals.at(static_cast<int>(value));
+  if (const auto* cardinal = constants::kCardinals.find(static_cast<int>(value))) {
+    return *cardinal;
   }
 
   // < 100
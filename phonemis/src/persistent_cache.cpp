@@ -0,0 +1,304 @@
+#include <phonemis/phonemizer/persistent_cache.h>
+#include <phonemis/phonemizer/constants.h>
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <functional>
+#include <mutex>
+#include <stdexcept>
+#include <type_traits>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define PHONEMIS_PERSISTENT_CACHE
+#endif
+
+namespace phonemis::phonemizer {
+
+using constants::cache::kFileFlushBytes;
+using constants::cache::kFileFlushMilliseconds;
+using constants::cache::kFileFormatVersion;
+using constants::cache::kFileMaxBytes;
+
+namespace {
+// File layout
+// A fixed size header, followed by the records, each aligned to 8 bytes:
+// record header (with the phonetic metadata), word bytes (padded to 4 bytes), phonemes (as UTF-32 code points).
+// Only the records before the `end` offset stored in the header are valid.
+constexpr char kMagic[8] = {'P', 'H', 'N', 'M', 'C', 'A', 'C', 'H'};
+
+struct FileHeader {
+  char magic[8];
+  uint64_t model_hash;
+  uint64_t end;           // Offset right after the last committed record
+  uint64_t reserved[5];
+};
+static_assert(sizeof(FileHeader) == 64);
+
+struct RecordHeader {
+  uint64_t context;       // See WordCache::context
+  uint32_t word_size;
+  uint32_t no_phonemes;
+  PhoneticInfo info;
+};
+static_assert(sizeof(RecordHeader) == 24 && std::is_trivially_copyable_v<PhoneticInfo>);
+
+size_t align(size_t size, size_t alignment) {
+  return (size + alignment - 1) / alignment * alignment;
+}
+
+size_t record_size(const RecordHeader& header) {
+  return align(sizeof(RecordHeader) + align(header.word_size, 4) + header.no_phonemes * sizeof(char32_t), 8);
+}
+
+size_t key_hash(std::string_view word, uint64_t context) {
+  return std::hash<std::string_view>()(word) ^ std::hash<uint64_t>()(context * 0x9e3779b97f4a7c15ULL);
+}
+} // namespace
+
+#ifdef PHONEMIS_PERSISTENT_CACHE
+
+PersistentCache::PersistentCache(const std::string& filepath, uint64_t model_hash)
+  : filepath_(filepath) {
+  // The file may be replaced by another process while waiting for the lock, in which case it is reopened
+  for (;;) {
+    fd_ = ::open(filepath_.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (fd_ < 0)
+      throw std::runtime_error("Failed to open file: " + filepath_);
+    ::flock(fd_, LOCK_EX);
+
+    struct stat fd_stat, path_stat;
+    if (::fstat(fd_, &fd_stat) == 0 && ::stat(filepath_.c_str(), &path_stat) == 0 &&
+        fd_stat.st_dev == path_stat.st_dev && fd_stat.st_ino == path_stat.st_ino)
+      break;
+    ::close(fd_);
+  }
+
+  try {
+    open_file(model_hash);
+    refresh();
+  } catch (...) {
+    ::close(fd_);
+    throw;
+  }
+  ::flock(fd_, LOCK_UN);
+}
+
+PersistentCache::~PersistentCache() {
+  try {
+    flush();
+  } catch (...) {
+    // Unsaved records are simply lost
+  }
+  if (mapping_ != nullptr)
+    ::munmap(const_cast<char*>(mapping_), mapping_size_);
+  ::close(fd_);
+}
+
+std::optional<Pronunciation> PersistentCache::find(const WordCache::Key& key) const {
+  const uint64_t context = WordCache::context(key);
+  const size_t hash = key_hash(key.word, context);
+
+  std::shared_lock<std::shared_mutex> lock(mutex_);
+  auto result = find_in(mapping_, index_, hash, key.word, context);
+  if (!result.has_value())
+    result = find_in(pending_.data(), pending_index_, hash, key.word, context);
+
+  if (result.has_value())
+    no_hits_.fetch_add(1, std::memory_order_relaxed);
+  return result;
+}
+
+void PersistentCache::insert(const WordCache::Key& key, const Pronunciation& pronunciation) {
+  const auto& phonemes = pronunciation.phonemes;
+  RecordHeader header = RecordHeader();   // Value-initialized, so that the padding is zeroed
+  header.context = WordCache::context(key);
+  header.word_size = static_cast<uint32_t>(key.word.size());
+  header.no_phonemes = static_cast<uint32_t>(phonemes.size());
+  header.info = pronunciation.info;
+
+  // Several threads may miss the same key, only the first of them queues it
+  const size_t hash = key_hash(key.word, header.context);
+  std::unique_lock<std::shared_mutex> lock(mutex_);
+  if (find_in(mapping_, index_, hash, key.word, header.context).has_value() ||
+      find_in(pending_.data(), pending_index_, hash, key.word, header.context).has_value())
+    return;
+
+  const size_t offset = pending_.size();
+  pending_.resize(offset + record_size(header), 0);
+  char* record = pending_.data() + offset;
+  std::memcpy(record, &header, sizeof(header));
+  std::memcpy(record + sizeof(header), key.word.data(), key.word.size());
+  std::memcpy(record + sizeof(header) + align(key.word.size(), 4), phonemes.data(), phonemes.size() * sizeof(char32_t));
+  pending_index_.emplace(hash, offset);
+
+  const auto now = std::chrono::steady_clock::now();
+  if (pending_.size() >= kFileFlushBytes || now - last_commit_ >= std::chrono::milliseconds(kFileFlushMilliseconds))
+    commit();
+}
+
+void PersistentCache::flush() {
+  std::unique_lock<std::shared_mutex> lock(mutex_);
+  commit();
+}
+
+size_t PersistentCache::no_entries() const {
+  std::shared_lock<std::shared_mutex> lock(mutex_);
+  return index_.size() + pending_index_.size();
+}
+
+void PersistentCache::open_file(uint64_t model_hash) {
+  FileHeader header;
+  struct stat file_stat;
+  const bool valid = ::pread(fd_, &header, sizeof(header), 0) == sizeof(header) &&
+                     ::fstat(fd_, &file_stat) == 0 &&
+                     std::memcmp(header.magic, kMagic, sizeof(kMagic)) == 0 &&
+                     header.model_hash == model_hash &&
+                     header.end >= sizeof(FileHeader) &&
+                     header.end <= static_cast<uint64_t>(file_stat.st_size);
+  if (valid)
+    return;
+
+  // Mismatched or damaged files may still be mapped by other processes, so they are replaced
+  // rather than overwritten. Only an empty (just created) file is initialized in place.
+  int fd = fd_;
+  std::string tmp_filepath;
+  if (::fstat(fd_, &file_stat) != 0 || file_stat.st_size > 0) {
+    tmp_filepath = filepath_ + ".tmp." + std::to_string(::getpid());
+    fd = ::open(tmp_filepath.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0)
+      throw std::runtime_error("Failed to open file: " + tmp_filepath);
+    ::flock(fd, LOCK_EX);
+  }
+
+  header = {};
+  std::memcpy(header.magic, kMagic, sizeof(kMagic));
+  header.model_hash = model_hash;
+  header.end = sizeof(FileHeader);
+  if (::pwrite(fd, &header, sizeof(header), 0) != sizeof(header) ||
+      (!tmp_filepath.empty() && ::rename(tmp_filepath.c_str(), filepath_.c_str()) != 0)) {
+    if (fd != fd_) {
+      ::unlink(tmp_filepath.c_str());
+      ::close(fd);
+    }
+    throw std::runtime_error("Failed to write file: " + filepath_);
+  }
+
+  if (fd != fd_) {
+    ::close(fd_);
+    fd_ = fd;
+  }
+}
+
+void PersistentCache::commit() {
+  last_commit_ = std::chrono::steady_clock::now();
+  ::flock(fd_, LOCK_EX);
+  try {
+    // Load the records appended by the other processes first, and skip the ones computed by both
+    // (as well as any key queued more than once)
+    refresh();
+    std::vector<char> records;
+    std::unordered_multimap<size_t, size_t> records_index;
+    records.reserve(pending_.size());
+    for (size_t offset = 0; offset < pending_.size();) {
+      RecordHeader header;
+      std::memcpy(&header, pending_.data() + offset, sizeof(header));
+      const size_t size = record_size(header);
+      const std::string_view word(pending_.data() + offset + sizeof(header), header.word_size);
+      const size_t hash = key_hash(word, header.context);
+      if (!find_in(mapping_, index_, hash, word, header.context).has_value() &&
+          !find_in(records.data(), records_index, hash, word, header.context).has_value()) {
+        records_index.emplace(hash, records.size());
+        records.insert(records.end(), pending_.begin() + offset, pending_.begin() + offset + size);
+      }
+      offset += size;
+    }
+    pending_.clear();
+    pending_index_.clear();
+
+    // The end offset is updated only after the records are written, so a failed or interrupted
+    // append leaves the file valid (the partially written records are overwritten later).
+    // A full file is kept as it is - it holds the words seen first, which tend to be the frequent ones.
+    FileHeader header;
+    if (!records.empty() && ::pread(fd_, &header, sizeof(header), 0) == sizeof(header) &&
+        header.end + records.size() <= kFileMaxBytes) {
+      const uint64_t end = header.end + records.size();
+      if (::pwrite(fd_, records.data(), records.size(), header.end) == static_cast<ssize_t>(records.size()))
+        ::pwrite(fd_, &end, sizeof(end), offsetof(FileHeader, end));
+    }
+    refresh();
+  } catch (...) {
+    ::flock(fd_, LOCK_UN);
+    throw;
+  }
+  ::flock(fd_, LOCK_UN);
+}
+
+void PersistentCache::refresh() {
+  FileHeader header;
+  if (::pread(fd_, &header, sizeof(header), 0) != sizeof(header) || header.end <= mapping_size_)
+    return;
+
+  void* mapping = ::mmap(nullptr, header.end, PROT_READ, MAP_SHARED, fd_, 0);
+  if (mapping == MAP_FAILED)
+    throw std::runtime_error("Failed to map file: " + filepath_);
+
+  index_records(static_cast<const char*>(mapping), std::max(mapping_size_, sizeof(FileHeader)), header.end);
+  if (mapping_ != nullptr)
+    ::munmap(const_cast<char*>(mapping_), mapping_size_);
+  mapping_ = static_cast<const char*>(mapping);
+  mapping_size_ = header.end;
+}
+
+#else
+
+PersistentCache::PersistentCache(const std::string& filepath, uint64_t) : filepath_(filepath) {
+  throw std::runtime_error("Persistent cache is not supported on this platform: " + filepath_);
+}
+PersistentCache::~PersistentCache() = default;
+std::optional<Pronunciation> PersistentCache::find(const WordCache::Key&) const { return std::nullopt; }
+void PersistentCache::insert(const WordCache::Key&, const Pronunciation&) {}
+void PersistentCache::flush() {}
+size_t PersistentCache::no_entries() const { return 0; }
+
+#endif
+
+void PersistentCache::index_records(const char* data, size_t begin, size_t end) {
+  for (size_t offset = begin; offset + sizeof(RecordHeader) <= end;) {
+    RecordHeader header;
+    std::memcpy(&header, data + offset, sizeof(header));
+    const size_t size = record_size(header);
+    if (offset + size > end)
+      break;
+
+    const std::string_view word(data + offset + sizeof(header), header.word_size);
+    index_.emplace(key_hash(word, header.context), offset);
+    offset += size;
+  }
+}
+
+std::optional<Pronunciation> PersistentCache::find_in(const char* data,
+                                                      const std::unordered_multimap<size_t, size_t>& index,
+                                                      size_t hash, std::string_view word, uint64_t context) const {
+  const auto [begin, end] = index.equal_range(hash);
+  for (auto it = begin; it != end; ++it) {
+    const char* record = data + it->second;
+    RecordHeader header;
+    std::memcpy(&header, record, sizeof(header));
+    if (header.context != context || header.word_size != word.size() ||
+        std::memcmp(record + sizeof(header), word.data(), word.size()) != 0)
+      continue;
+
+    std::u32string phonemes(header.no_phonemes, U'\0');
+    std::memcpy(phonemes.data(), record + sizeof(header) + align(header.word_size, 4),
+                header.no_phonemes * sizeof(char32_t));
+    return Pronunciation(std::move(phonemes), header.info);
+  }
+  return std::nullopt;
+}
+
+} // namespace phonemis::phonemizer
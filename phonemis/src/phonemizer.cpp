@@ -1,6 +1,8 @@
 #include <phonemis/phonemizer/phonemizer.h>
 #include <phonemis/phonemizer/constants.h>
+#include <phonemis/utilities/io_utils.h>
 #include <phonemis/utilities/string_utils.h>
+#include <string_view>
 #include <vector>
 #include <iostream>
 
@@ -8,33 +10,128 @@ namespace phonemis::phonemizer {
 
 using namespace utilities;
 
-Phonemizer::Phonemizer(Lang language, const std::string& lexicon_filepath) {
-  if (!lexicon_filepath.empty())
-    lexicon_ = std::make_unique<Lexicon>(language, lexicon_filepath);
+namespace {
+// Identifies the models the phonemizations depend on - the lexicon, the language and the rules
+uint64_t model_hash(Lang language, const std::string& lexicon_filepath) {
+  uint64_t hash = 0xcbf29ce484222325ULL;
+  for (uint64_t value : {constants::cache::kFileFormatVersion,
+                         constants::kRulesVersion,
+                         constants::kRulesFingerprint,
+                         static_cast<uint64_t>(language),
+                         lexicon_filepath.empty() ? 0 : io_utils::hash_file(lexicon_filepath)})
+    hash = (hash ^ value) * 0x100000001b3ULL;
+  return hash;
 }
+} // namespace
 
-std::u32string 
-Phonemizer::phonemize(const std::string& word,
-                      const tagger::Tag& tag,
-                      std::optional<float> base_stress,
-                      std::optional<bool> vowel_next) const {
+Phonemizer::Phonemizer(Lang language, const std::string& lexicon_filepath, Config config) {
+  if (!lexicon_filepath.empty()) {
+    std::vector<std::string> hot_words;
+    if (!config.hot_words_filepath.empty())
+      hot_words = io_utils::load_words(config.hot_words_filepath, config.hot_words_capacity);
+    lexicon_ = std::make_unique<Lexicon>(language, lexicon_filepath, hot_words);
+  }
+  if (config.cache_capacity > 0)
+    cache_ = std::make_unique<WordCache>(config.cache_capacity);
+  if (!config.cache_filepath.empty())
+    file_cache_ = std::make_unique<PersistentCache>(config.cache_filepath, model_hash(language, lexicon_filepath));
+}
+
+PronunciationRef 
+Phonemizer::pronounce_ref(const std::string& word,
+                          tagger::Tag tag,
+                          std::optional<float> base_stress,
+                          std::optional<bool> vowel_next,
+                          std::optional<tokenizer::WordId> id) const {
   if (word.empty())
-    return U"";
+    return {};
+
+  if (cache_ == nullptr && file_cache_ == nullptr)
+    return pronounce_uncached(word, tag, base_stress, vowel_next, id);
+
+  // Hot words are served before the caches, which are left to the less frequent words
+  if (lexicon_ != nullptr) {
+    if (auto phonemes = lexicon_->pronounce_hot(word, tag, base_stress))
+      return std::move(*phonemes);
+  }
+
+  const WordCache::Key key = {word, tag, base_stress, vowel_next};
+  if (cache_ != nullptr) {
+    if (auto cached = cache_->find(key))
+      return std::move(*cached);
+  }
+
+  // The caches store their own copies, so the phonemization is copied once for all of them.
+  // Only the words resolved by the rules (suffix stemming, fallback) are kept in the cache file,
+  // the dictionary words are looked up faster than the file is read.
+  const bool is_persisted = file_cache_ != nullptr && is_rule_based(word);
+  std::optional<Pronunciation> phonemes;
+  if (is_persisted)
+    phonemes = file_cache_->find(key);
+  if (!phonemes.has_value()) {
+    phonemes = pronounce_uncached(word, tag, base_stress, vowel_next, id).to_pronunciation();
+    if (is_persisted)
+      file_cache_->insert(key, *phonemes);
+  }
+
+  if (cache_ != nullptr)
+    cache_->insert(key, *phonemes);
+  return std::move(*phonemes);
+}
+
+void Phonemizer::bind(tokenizer::Vocabulary& vocabulary) {
+  if (lexicon_ != nullptr)
+    lexicon_->bind(vocabulary);
+}
+
+void Phonemizer::prefetch(std::span<const std::string_view> words, std::span<const tokenizer::WordId> ids) const {
+  if (lexicon_ == nullptr)
+    return;
+
+  thread_local std::vector<const Pronunciation*> results;
+  results.resize(words.size());
+  lexicon_->find_batch(words, results, ids);
+}
+
+WordCacheStats Phonemizer::cache_stats() const {
+  WordCacheStats stats = cache_ != nullptr ? cache_->stats() : WordCacheStats{};
+  if (file_cache_ != nullptr) {
+    stats.no_file_hits = file_cache_->no_hits();
+    stats.no_file_entries = file_cache_->no_entries();
+  }
+  return stats;
+}
+
+void Phonemizer::flush_cache() const {
+  if (file_cache_ != nullptr)
+    file_cache_->flush();
+}
+
+bool Phonemizer::is_rule_based(const std::string& word) const {
+  return lexicon_ != nullptr && !lexicon_->is_known(word) && lexicon_->derived_entry(word) == nullptr;
+}
+
+PronunciationRef 
+Phonemizer::pronounce_uncached(const std::string& word,
+                               tagger::Tag tag,
+                               std::optional<float> base_stress,
+                               std::optional<bool> vowel_next,
+                               std::optional<tokenizer::WordId> id) const {
   
-  std::u32string phonemes = U"";
+  PronunciationRef phonemes;
   
   if (lexicon_ != nullptr)
-    phonemes = lexicon_->get(word, tag, base_stress, vowel_next);
+    phonemes = lexicon_->pronounce_ref(word, tag, base_stress, vowel_next, id);
   
   if (phonemes.empty() && string_utils::is_alpha(word))
-    phonemes = fallback(word, tag);
+    phonemes = Pronunciation(fallback(word, tag));
   
   return phonemes;
 }
 
 std::u32string 
 Phonemizer::fallback(const std::string& word,
-                     const tagger::Tag& tag) const {
+                     tagger::Tag tag) const {
   // The main idea behind the fallback algorithm is to syllabify the words,
   // and then perform lookup phonemization for well known, short syllabes.
   // We make an assumption, that the best phonemization is the shortest one 
@@ -46,80 +143,87 @@ Phonemizer::fallback(const std::string& word,
 
   // TODO: some preprocessing, like eliminating special characters?
   // ...
-  auto lword = string_utils::to_lower(word);
-  int32_t length = word.size();
-
-  if (lword.empty())
+  if (word.empty() || lexicon_ == nullptr)
     return U"";
 
-  // Define DP table with both DP function values & corresponding phonemizations.
-  // TODO: can be done in leaner time, by storing indices instead of phonemes
+  // Per-thread buffers, kept between the calls
+  thread_local std::string lword;
+  thread_local std::vector<FallbackCell> dp_table;
+  thread_local std::vector<int32_t> ends;
+
+  lword = word;
+  string_utils::to_lower__(lword);
+  const int32_t length = lword.size();
+
+  // Multi-character syllabes are skipped for the words made of vowels only, which are spelled out
+  // with the single character entries (the check does not depend on the syllabe, so it is done once)
+  const bool has_non_vowel = lword.find_first_not_of(constants::alphabet::kVowels) != std::string::npos;
+
+  // Define DP table with the lengths of the shortest phonemizations of each prefix,
+  // and the syllabes ending them (the phonemes are built once, when the best path is known)
   constexpr int32_t INF = 1e5;
-  std::vector<std::pair<int32_t, std::u32string>> dpTable(length, {INF, U""});
-
-  // Iterate through each character of the input word
-  for (int32_t i = 0; i < length; i++) {
-    // Now check all possible syllabes ending with the word[i]
-    // By starting with the longest syllable, we ensure that 
-    // the solution with longer syllables will be preferred if there is a tie in phonemization length.
-    // `d` stands for number of characters in syllabe other than word[i].
-    for (int32_t d = std::min(i, constants::kMaxSyllabeLength - 1); d >= 0; d--) {
-      auto syllabe = lword.substr(i - d, d + 1);
-      
-      // A syllabe must contain at least one vowel (or be degenerated to a single consonant)
-      auto hasVowel = !string_utils::filter(lword, [](char c) -> bool {
-        return constants::alphabet::kVowels.find(c) != std::string::npos;
-      }).empty();
-      if (syllabe.size() > 1 && !hasVowel)
-        continue;
-      
-      if (lexicon_->is_known(syllabe)) {
-        // Simple lookup
-        auto phonemes = lexicon_->get(syllabe);
-        int32_t plength = phonemes.size();
-
-        if (phonemes.empty())
-          continue;
-
-        // We do in fact apply some very minimalistic postprocessing
-        // For example, handle special cases of syllabes with 'e' at the end.
-        if (i < length - 1 &&
-            syllabe.back() == 'e' && 
-            constants::language::kConsonants.find(phonemes.back()) != std::u32string::npos)
-          phonemes += U"ɜ";
-
-        // Or replace the primary stress with the secondary stress in case of
-        // trailing syllabes.
-        auto primary_stress_pos = phonemes.find(constants::stress::kPrimary);
-        if (i > d && primary_stress_pos != std::u32string::npos)
-          phonemes[primary_stress_pos] = constants::stress::kSecondary;
-        
-        // Apply penalty for using syllabes starting with vowels
-        if (i > d && 
-            constants::alphabet::kVowels.find(syllabe.front()) != std::string::npos)
-          plength += constants::kVowelSyllabePenalty;
-        
-        int32_t totalPLength = plength;
-        auto totalPhonemes = phonemes;
-        if (i > d) {
-          totalPLength += dpTable[i - d - 1].first;
-          totalPhonemes = dpTable[i - d - 1].second + phonemes;
-        }
-        
-        // Update the DP table
-        if (totalPLength < dpTable[i].first) {
-          dpTable[i].first = totalPLength;
-          dpTable[i].second = totalPhonemes;
-        }
-      }
-    }
+  dp_table.assign(length, FallbackCell{INF, 0, nullptr});
+
+  // Iterate through the syllabes starting at each character of the input word,
+  // all of them found in a single walk of the syllabe index.
+  // The prefix before the syllabe is final by then, so its phonemization is extended right away.
+  // The starts are visited in order, so on a tie in phonemization length the solution
+  // with the longer last syllabe (the one starting earlier) is preferred.
+  const auto& syllables = lexicon_->syllables();
+  for (int32_t begin = 0; begin < length; begin++) {
+    // Prefixes which cannot be phonemized cannot be extended either
+    const int32_t prefix_length = begin > 0 ? dp_table[begin - 1].length : 0;
+    if (prefix_length == INF)
+      continue;
+
+    // Apply penalty for using syllabes starting with vowels
+    const int32_t penalty = begin > 0 && 
+                            constants::alphabet::kVowels.find(lword[begin]) != std::string::npos ?
+                            constants::kVowelSyllabePenalty : 0;
+
+    const auto rest = std::string_view(lword).substr(begin, has_non_vowel ? std::string_view::npos : 1);
+    syllables.match(rest, [&](size_t size, const SyllableIndex::Syllable& syllable) {
+      // Update the DP table
+      auto& cell = dp_table[begin + size - 1];
+      const int32_t total_length = prefix_length + syllable.no_phonemes + penalty;
+      if (total_length < cell.length)
+        cell = {total_length, begin, &syllable};
+    });
   }
 
-  // If the resulting length is not infinite (not equal to INF constant),
-  // then we were able to phonemize the word.
-  auto [bestLength, bestPhonemization] = dpTable[length - 1];
-  
-  return bestLength != INF ? bestPhonemization : U"";
+  // If the resulting length is infinite (equal to INF constant),
+  // then we were not able to phonemize the word.
+  if (dp_table[length - 1].length == INF)
+    return U"";
+
+  // Follow the best path back to collect its syllabes
+  ends.clear();
+  size_t no_phonemes = 0;
+  for (int32_t i = length - 1; i >= 0; i = dp_table[i].start - 1) {
+    ends.push_back(i);
+    no_phonemes += dp_table[i].syllable->no_phonemes + 1;
+  }
+
+  std::u32string phonemization;
+  phonemization.reserve(no_phonemes);
+  for (auto it = ends.rbegin(); it != ends.rend(); it++) {
+    const int32_t i = *it;
+    const auto& [_, begin, syllable] = dp_table[i];
+    const size_t offset = phonemization.size();
+    phonemization += syllables.phonemes(*syllable);
+
+    // We do in fact apply some very minimalistic postprocessing
+    // For example, handle special cases of syllabes with 'e' at the end.
+    if (i < length - 1 && syllable->silent_e)
+      phonemization += U"ɜ";
+
+    // Or replace the primary stress with the secondary stress in case of
+    // trailing syllabes.
+    if (begin > 0 && syllable->primary != SyllableIndex::kNoStress)
+      phonemization[offset + syllable->primary] = constants::stress::kSecondary;
+  }
+
+  return phonemization;
 }
 
 } // namespace phonemis::phonemizer
\ No newline at end of file
@@ -0,0 +1,71 @@
+#include <phonemis/phonemizer/phonetics.h>
+#include <phonemis/phonemizer/constants.h>
+
+namespace phonemis::phonemizer {
+
+using namespace constants::language;
+
+namespace {
+PhonemeClass classify(char32_t phoneme) {
+  if (phoneme <= 127 && constants::alphabet::kNonQuotePunctations.contains(static_cast<char>(phoneme)))
+    return PhonemeClass::PUNCTUATION;
+  if (kVowels.find(phoneme) != std::u32string::npos)
+    return PhonemeClass::VOWEL;
+  if (kConsonants.find(phoneme) != std::u32string::npos)
+    return PhonemeClass::CONSONANT;
+  return PhonemeClass::NONE;
+}
+
+uint16_t last_traits(std::u32string_view phonemes) {
+  if (phonemes.empty())
+    return 0;
+
+  const char32_t last = phonemes.back();
+  uint16_t traits = 0;
+  if (kHardSEndings.find(last) != std::u32string::npos) traits |= ending::kHardS;
+  if (kSibilantEndings.find(last) != std::u32string::npos) traits |= ending::kSibilant;
+  if (kVoicelessEndings.find(last) != std::u32string::npos) traits |= ending::kVoiceless;
+  if (kUSTaus.find(last) != std::u32string::npos) traits |= ending::kTau;
+  if (last == U'd') traits |= ending::kD;
+  if (last == U't') traits |= ending::kT;
+  if (last == U'ə' || last == U'ː') traits |= ending::kLong;
+  if (last == constants::stress::kPrimary || last == constants::stress::kSecondary) traits |= ending::kStress;
+  if (last == U't' && phonemes.size() > 1 && kUSTaus.find(phonemes[phonemes.size() - 2]) != std::u32string::npos)
+    traits |= ending::kTauT;
+  return traits;
+}
+} // namespace
+
+PhoneticInfo analyze(std::u32string_view phonemes) {
+  PhoneticInfo info;
+  for (char32_t phoneme : phonemes) {
+    info.has_primary |= phoneme == constants::stress::kPrimary;
+    info.has_secondary |= phoneme == constants::stress::kSecondary;
+
+    const PhonemeClass phoneme_class = classify(phoneme);
+    info.has_vowel |= phoneme_class == PhonemeClass::VOWEL;
+    if (info.first == PhonemeClass::NONE)
+      info.first = phoneme_class;
+  }
+  info.last = last_traits(phonemes);
+  return info;
+}
+
+Pronunciation::Pronunciation(std::u32string phonemes)
+  : phonemes(std::move(phonemes)), info(analyze(this->phonemes)) {}
+
+Pronunciation& Pronunciation::append(std::u32string_view suffix, size_t no_replaced) {
+  const PhoneticInfo suffix_info = analyze(suffix);
+  phonemes.resize(phonemes.size() - no_replaced);
+  phonemes += suffix;
+
+  info.has_primary |= suffix_info.has_primary;
+  info.has_secondary |= suffix_info.has_secondary;
+  info.has_vowel |= suffix_info.has_vowel;
+  if (info.first == PhonemeClass::NONE)
+    info.first = suffix_info.first;
+  info.last = last_traits(phonemes);
+  return *this;
+}
+
+} // namespace phonemis::phonemizer
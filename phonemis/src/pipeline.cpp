@@ -6,24 +6,27 @@ namespace phonemis {
 
 using namespace utilities;
 using phonemizer::constants::alphabet::kPunctations;
-using phonemizer::constants::alphabet::kNonQuotePunctations;
-using phonemizer::constants::language::kVowels;
-using phonemizer::constants::language::kConsonants;
 using tagger::Tag;
 
 Pipeline::Pipeline(Lang language,
                    const std::string& tagger_data_filepath,
-                   const std::string& lexicon_data_filepath)
+                   const std::string& lexicon_data_filepath,
+                   tagger::Config tagger_config,
+                   phonemizer::Config phonemizer_config)
   : language_(language) {
   if (!tagger_data_filepath.empty())
-    tagger_ = std::make_unique<Tagger>(tagger_data_filepath);
+    tagger_ = std::make_unique<Tagger>(tagger_data_filepath, tagger_config);
   
-  phonemizer_ = std::make_unique<Phonemizer>(language, lexicon_data_filepath);
+  phonemizer_ = std::make_unique<Phonemizer>(language, lexicon_data_filepath, phonemizer_config);
+
+  if (tagger_)
+    tagger_->bind(*vocabulary_);
+  phonemizer_->bind(*vocabulary_);
 }
 
 // TODO: It works fine, but there are still some missing parts
 // of the solution
-std::u32string Pipeline::process(const std::string& text) {
+std::u32string Pipeline::process(const std::string& text) const {
   // Start by preprocessing the text
   // Normalize the text to replace any foreign characters.
   auto normalized_text = preprocessor::normalize_unicode(text);
@@ -35,26 +38,42 @@ std::u32string Pipeline::process(const std::string& text) {
   // the text for separate sentences to be processed.
   auto sentences = preprocessor::split_sentences(verbalized_text);
 
+  // Tokenize all the sentences first, so that they can be tagged in a single batch
+  std::vector<std::vector<tokenizer::Token>> tokenized_sentences;
+  tokenized_sentences.reserve(sentences.size());
+  for (const auto& sentence : sentences)
+    tokenized_sentences.push_back(tokenizer::tokenize(sentence, vocabulary_.get()));
+
+  // Apply tagging
+  // If tagger is not defined (that is, if user has not passed the tagger data file)
+  // we simply mark tokens with 'unknown' tag.
+  if (tagger_)
+    tagger_->tag_batch(tokenized_sentences);
+  else {
+    for (auto& tokens : tokenized_sentences)
+      for (auto& token : tokens)
+        token.tag = std::make_optional<Tag>(Tag::XX);
+  }
+
   // Each sentence is processed in similar way, and the results
   // are concatenated at the end.
   std::u32string phonemized_text = U"";
-  for (const auto& sentence : sentences) {
-    // Tokenize the sentence with tokenizer
-    auto tokens = tokenizer::tokenize(sentence);
-
-    // Apply tagging
-    // If tagger is not defined (that is, if user has not passed the tagger data file)
-    // we simply mark tokens with 'unknown' tag.
-    if (tagger_)
-      tagger_->tag(tokens);
-    else {
-      for (auto& token : tokens)
-        token.tag = std::make_optional(Tag("XX"));
-    }
-
+  std::vector<std::string_view> words;
+  std::vector<tokenizer::WordId> ids;
+  for (const auto& tokens : tokenized_sentences) {
     // TODO: intermediate part of preprocessing
     std::optional<bool> vowel_next = {};
 
+    // The tokens are phonemized one after another (each depends on the previous one),
+    // so their lexicon entries are fetched for the whole sentence upfront
+    words.clear();
+    ids.clear();
+    for (const auto& token : tokens) {
+      words.push_back(token.text);
+      ids.push_back(token.id);
+    }
+    phonemizer_->prefetch(words, ids);
+
     // Phonemize tokens
     // We concatenate phonemized words and add unchanged white spaces
     // and punctation characters.
@@ -66,7 +85,10 @@ std::u32string Pipeline::process(const std::string& text) {
       const auto& word = token.text;
       const auto& tag = token.tag.value();
 
-      auto phonemes = phonemizer_->phonemize(word, tag, {}, vowel_next);
+      // Phonemizations served unchanged by the lexicon are appended straight from its entries
+      const auto pronunciation = phonemizer_->pronounce_ref(word, tag, {}, vowel_next, token.id);
+      const auto phonemes = pronunciation.phonemes();
+      const auto& info = pronunciation.info();
       phonemized_sentence += phonemes;
 
       // Handle reimaining punctation characters
@@ -81,22 +103,13 @@ std::u32string Pipeline::process(const std::string& text) {
       if (!token.whitespace.empty())
         phonemized_sentence += string_utils::utf8_to_u32string(token.whitespace);
 
-      // Check if the latest phonemization contains any vowels
+      // Check if the first vowel, consonant or punctuation of the latest phonemization is a vowel
       // This will affect the following phonemization (of the next token).
-      // TODO: should be moved into Phonemizer's territory
-      for (char32_t p : phonemes) {
-        if (p <= 127 && kNonQuotePunctations.contains(static_cast<char>(p))) {
-          vowel_next = {};
-          break;
-        }
-        else if (kVowels.find(p) != std::u32string::npos) {
-          vowel_next = {true};
-          break;
-        }
-        else if (kConsonants.find(p) != std::u32string::npos) {
-          vowel_next = {false};
-          break;
-        }
+      switch (info.first) {
+        case phonemizer::PhonemeClass::PUNCTUATION: vowel_next = {}; break;
+        case phonemizer::PhonemeClass::VOWEL: vowel_next = {true}; break;
+        case phonemizer::PhonemeClass::CONSONANT: vowel_next = {false}; break;
+        case phonemizer::PhonemeClass::NONE: break;
       }
     }
 
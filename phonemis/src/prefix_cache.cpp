@@ -0,0 +1,141 @@
+#include <phonemis/tagger/prefix_cache.h>
+#include <algorithm>
+#include <functional>
+
+namespace phonemis::tagger {
+
+namespace {
+// Key of the (empty) root prefix
+constexpr uint64_t kRootKey = 0x9e3779b97f4a7c15ULL;
+} // namespace
+
+PrefixCache::PrefixCache(size_t capacity_bytes)
+  : capacity_bytes_(capacity_bytes) {}
+
+size_t PrefixCache::restore(const std::vector<tokenizer::Token>& sentence, Workspace& workspace) {
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  // Follow the sentence down the trie as long as the columns are cached
+  auto& offsets = workspace.offsets;
+  auto& states = workspace.states;
+  auto& emit = workspace.emit;
+  auto& v = workspace.v;
+  auto& back_pointer = workspace.back_pointer;
+
+  Workspace::ensure(v, 0);
+  Workspace::ensure(back_pointer, 0);
+
+  size_t length = 0;
+  uint64_t key = kRootKey;
+  for (; length < sentence.size(); ++length) {
+    const uint64_t next_key = child_key(key, sentence[length].text);
+    const Node* node = find(next_key, key, sentence[length].text);
+    if (node == nullptr)
+      break;
+
+    states.insert(states.end(), node->states.begin(), node->states.end());
+    emit.insert(emit.end(), node->emit.begin(), node->emit.end());
+    v.insert(v.end(), node->v.begin(), node->v.end());
+    back_pointer.insert(back_pointer.end(), node->back_pointer.begin(), node->back_pointer.end());
+    offsets[length + 1] = states.size();
+    key = next_key;
+  }
+
+  // Mark the used nodes as recently used, the deepest first.
+  // This way, a node is never used less recently than its descendants, so only leaves are evicted.
+  while (key != kRootKey) {
+    auto& node = nodes_.at(key);
+    lru_.splice(lru_.begin(), lru_, node.lru_it);
+    key = node.parent_key;
+  }
+
+  (length > 0 ? no_hits_ : no_misses_)++;
+  no_restored_columns_ += length;
+  no_computed_columns_ += sentence.size() - length;
+  return length;
+}
+
+void PrefixCache::store(const std::vector<tokenizer::Token>& sentence, size_t from, const Workspace& workspace) {
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  const auto& offsets = workspace.offsets;
+  uint64_t key = kRootKey;
+  for (size_t t = 0; t < sentence.size(); ++t) {
+    const uint64_t next_key = child_key(key, sentence[t].text);
+    auto [it, inserted] = nodes_.try_emplace(next_key);
+    auto& node = it->second;
+
+    if (inserted) {
+      // Columns before `from` were restored, they can only be missing if evicted in the meantime
+      if (t < from) {
+        nodes_.erase(it);
+        break;
+      }
+      node.parent_key = key;
+      node.word = sentence[t].text;
+      node.states.assign(workspace.states.begin() + offsets[t], workspace.states.begin() + offsets[t + 1]);
+      node.emit.assign(workspace.emit.begin() + offsets[t], workspace.emit.begin() + offsets[t + 1]);
+      node.v.assign(workspace.v.begin() + offsets[t], workspace.v.begin() + offsets[t + 1]);
+      node.back_pointer.assign(workspace.back_pointer.begin() + offsets[t], workspace.back_pointer.begin() + offsets[t + 1]);
+      node.lru_it = lru_.insert(lru_.end(), next_key);
+      memory_bytes_ += node.memory();
+    }
+    // Hash collision with another prefix - the rest of the sentence is not cached
+    else if (node.parent_key != key || node.word != sentence[t].text)
+      break;
+
+    key = next_key;
+  }
+
+  // Mark the stored nodes as recently used, the deepest first (see restore)
+  while (key != kRootKey) {
+    auto& node = nodes_.at(key);
+    lru_.splice(lru_.begin(), lru_, node.lru_it);
+    key = node.parent_key;
+  }
+
+  evict();
+}
+
+PrefixCacheStats PrefixCache::stats() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return {no_hits_, no_misses_, no_restored_columns_, no_computed_columns_,
+          no_evictions_, nodes_.size(), memory_bytes_};
+}
+
+uint64_t PrefixCache::child_key(uint64_t parent_key, const std::string& word) {
+  // splitmix64 finalizer over the combined keys
+  uint64_t key = parent_key ^ (std::hash<std::string>()(word) + 0x9e3779b97f4a7c15ULL + (parent_key << 6) + (parent_key >> 2));
+  key = (key ^ (key >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  key = (key ^ (key >> 27)) * 0x94d049bb133111ebULL;
+  return key ^ (key >> 31);
+}
+
+const PrefixCache::Node* PrefixCache::find(uint64_t key, uint64_t parent_key, const std::string& word) const {
+  const auto it = nodes_.find(key);
+  if (it == nodes_.end() || it->second.parent_key != parent_key || it->second.word != word)
+    return nullptr;
+  return &it->second;
+}
+
+void PrefixCache::evict() {
+  while (memory_bytes_ > capacity_bytes_ && !lru_.empty()) {
+    const auto it = nodes_.find(lru_.back());
+    memory_bytes_ -= it->second.memory();
+    nodes_.erase(it);
+    lru_.pop_back();
+    no_evictions_++;
+  }
+}
+
+size_t PrefixCache::Node::memory() const {
+  // Node itself, its hash map & LRU list entries and the column tables
+  return sizeof(Node) + sizeof(uint64_t) + 4 * sizeof(void*) +
+         word.capacity() +
+         states.capacity() * sizeof(TagIndex) +
+         emit.capacity() * sizeof(double) +
+         v.capacity() * sizeof(double) +
+         back_pointer.capacity() * sizeof(uint32_t);
+}
+
+} // namespace phonemis::tagger
@@ -0,0 +1,154 @@
+#include <phonemis/tagger/streaming_tagger.h>
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+
+namespace phonemis::tagger {
+
+StreamingTagger::StreamingTagger(const Tagger& tagger, size_t lag)
+  : tagger_(tagger), lag_(lag) {
+  if (tagger.config_.mode == Mode::BEAM || tagger.config_.mode == Mode::GREEDY)
+    throw std::invalid_argument("Streaming tagger does not support the pruning modes (beam, greedy)");
+}
+
+void StreamingTagger::push(tokenizer::Token token, std::vector<tokenizer::Token>& finalized) {
+  // The first token of a sentence is probed in lower case as well (see Tagger::tag)
+  const bool is_first = no_pending_ == 0 && !anchor_.has_value();
+  Column& column = push_column();
+  column.token = std::move(token);
+
+  const auto& word = column.token.text;
+  tagger_.candidates(column.token, is_first ? tagger_.lowerized_first(word, workspace_) : nullptr, workspace_);
+  column.states = workspace_.column_tags;
+  column.emit_scores = workspace_.emit_scores;
+  advance(no_pending_ - 1);
+
+  // Early emission
+  // Tokens on which all the surviving paths agree are final, no matter what comes next.
+  if (auto convergence = converged())
+    emit(convergence->first, convergence->second, finalized);
+
+  // Fixed-lag emission
+  // The oldest token gets the tag from the currently best path. Since this might cut off
+  // the paths which pending columns were built on, they are recomputed from the committed state.
+  while (no_pending_ > lag_) {
+    const auto& last = this->column(no_pending_ - 1);
+    size_t slot = std::distance(last.v.begin(), std::max_element(last.v.begin(), last.v.end()));
+    for (size_t i = no_pending_ - 1; i > 0; --i)
+      slot = this->column(i).back_pointer[slot];
+
+    emit(1, slot, finalized);
+    for (size_t i = 0; i < no_pending_; ++i)
+      advance(i);
+
+    if (auto convergence = converged())
+      emit(convergence->first, convergence->second, finalized);
+  }
+}
+
+void StreamingTagger::flush(std::vector<tokenizer::Token>& finalized) {
+  if (no_pending_ > 0) {
+    const auto& last = column(no_pending_ - 1);
+    size_t slot = std::distance(last.v.begin(), std::max_element(last.v.begin(), last.v.end()));
+    emit(no_pending_, slot, finalized);
+  }
+
+  anchor_.reset();
+}
+
+StreamingTagger::Column& StreamingTagger::push_column() {
+  // All the slots are pending - the ring grows, with the pending columns moved to its front
+  if (no_pending_ == ring_.size()) {
+    std::rotate(ring_.begin(), ring_.begin() + head_, ring_.end());
+    head_ = 0;
+    ring_.emplace_back();
+  }
+  return column(no_pending_++);
+}
+
+void StreamingTagger::pop_column() {
+  head_ = (head_ + 1) % ring_.size();
+  --no_pending_;
+}
+
+void StreamingTagger::advance(size_t idx) {
+  auto& column = this->column(idx);
+  column.v.resize(column.states.size());
+  column.back_pointer.assign(column.states.size(), 0);
+
+  // Initialization - the first word of a sentence
+  if (idx == 0 && !anchor_.has_value()) {
+    for (size_t i = 0; i < column.states.size(); ++i)
+      column.v[i] = tagger_.start_scores_[column.states[i]] + column.emit_scores[i];
+    return;
+  }
+
+  // Continuation of a committed path
+  // Only the anchor state survives in the preceding column, so its score can be treated as 0.
+  if (idx == 0) {
+    for (size_t i = 0; i < column.states.size(); ++i)
+      column.v[i] = tagger_.transition_score(anchor_.value(), column.states[i]) + column.emit_scores[i];
+    return;
+  }
+
+  // Recursion
+  const auto& prev = this->column(idx - 1);
+  for (size_t i = 0; i < column.states.size(); ++i) {
+    double max_score = -std::numeric_limits<double>::infinity();
+    uint32_t best_prev = 0;
+
+    for (size_t j = 0; j < prev.states.size(); ++j) {
+      double score = prev.v[j] + tagger_.transition_score(prev.states[j], column.states[i]);
+      if (score > max_score) {
+        max_score = score;
+        best_prev = static_cast<uint32_t>(j);
+      }
+    }
+
+    column.v[i] = max_score + column.emit_scores[i];
+    column.back_pointer[i] = best_prev;
+  }
+}
+
+void StreamingTagger::emit(size_t count, size_t slot, std::vector<tokenizer::Token>& finalized) {
+  // Backtracking path
+  anchor_ = column(count - 1).states[slot];
+  for (size_t t = count - 1; ; --t) {
+    auto& column = this->column(t);
+    column.token.tag = tagger_.tags_[column.states[slot]];
+    if (t == 0) break;
+    slot = column.back_pointer[slot];
+  }
+
+  for (size_t t = 0; t < count; ++t) {
+    finalized.push_back(std::move(column(0).token));
+    pop_column();
+  }
+}
+
+std::optional<std::pair<size_t, size_t>> StreamingTagger::converged() {
+  if (no_pending_ == 0)
+    return std::nullopt;
+
+  // Follow all the surviving paths backwards at once, until they meet
+  slots_.resize(column(no_pending_ - 1).states.size());
+  for (size_t i = 0; i < slots_.size(); ++i)
+    slots_[i] = static_cast<uint32_t>(i);
+
+  for (size_t t = no_pending_ - 1; ; --t) {
+    if (slots_.size() == 1)
+      return std::make_pair(t + 1, static_cast<size_t>(slots_[0]));
+    if (t == 0)
+      return std::nullopt;
+
+    next_slots_.clear();
+    const auto& column = this->column(t);
+    for (uint32_t slot : slots_)
+      next_slots_.push_back(column.back_pointer[slot]);
+    std::sort(next_slots_.begin(), next_slots_.end());
+    next_slots_.erase(std::unique(next_slots_.begin(), next_slots_.end()), next_slots_.end());
+    std::swap(slots_, next_slots_);
+  }
+}
+
+} // namespace phonemis::tagger
@@ -8,36 +8,59 @@ using namespace utilities;
 using constants::language::kVowels;
 
 std::u32string apply_stress(const std::u32string& phonemes, float stress) {
-  std::u32string result = phonemes;
+  return apply_stress(Pronunciation(phonemes), stress).phonemes;
+}
+
+bool changes_stress(const PhoneticInfo& info, float stress) {
+  // Mirrors the cases of apply_stress
+  const bool has_marks = info.has_primary || info.has_secondary;
+  if (stress < -1.F || stress == -1.F || (stress == 0.F || stress == 0.5F) && info.has_primary)
+    return has_marks;
+  if ((stress == 0.F || stress == 0.5F || stress == 1.F) && !has_marks && info.has_vowel)
+    return true;
+  if (stress >= 1.F && !info.has_primary && info.has_secondary)
+    return true;
+  return stress > 1.F && !has_marks && info.has_vowel;
+}
 
-  bool has_primary = phonemes.find(constants::stress::kPrimary) != std::u32string::npos;
-  bool has_secondary = phonemes.find(constants::stress::kSecondary) != std::u32string::npos;
-  bool has_vowel = std::any_of(
-    phonemes.begin(), phonemes.end(),                           
-    [](auto c) -> bool { return kVowels.find(c) != std::u32string::npos; }
-  );
+Pronunciation apply_stress(const Pronunciation& pronunciation, float stress) {
+  const auto& [phonemes, info] = pronunciation;
+  Pronunciation result = pronunciation;
 
   if (stress < -1.F) {
-    string_utils::replace__(result, constants::stress::kPrimary, {});
-    string_utils::replace__(result, constants::stress::kSecondary, {});
+    string_utils::replace__(result.phonemes, constants::stress::kPrimary, {});
+    string_utils::replace__(result.phonemes, constants::stress::kSecondary, {});
+    result.info.has_primary = result.info.has_secondary = false;
   }
-  else if (stress == -1.F || (stress == 0.F || stress == 0.5F) && has_primary) {
-    string_utils::replace__(result, constants::stress::kSecondary, {});
-    string_utils::replace__(result, constants::stress::kPrimary,
+  else if (stress == -1.F || (stress == 0.F || stress == 0.5F) && info.has_primary) {
+    string_utils::replace__(result.phonemes, constants::stress::kSecondary, {});
+    string_utils::replace__(result.phonemes, constants::stress::kPrimary,
                                   {constants::stress::kSecondary});    
+    result.info.has_secondary = info.has_primary;
+    result.info.has_primary = false;
   }
   else if ((stress == 0.F || stress == 0.5F || stress == 1.F ) &&
-           !has_primary && !has_secondary && has_vowel) {
-    return restress(std::u32string(1, constants::stress::kSecondary) + result);
+           !info.has_primary && !info.has_secondary && info.has_vowel) {
+    // The mark is moved before a vowel, so neither the first deciding nor the last phoneme changes
+    result.phonemes = restress(std::u32string(1, constants::stress::kSecondary) + phonemes);
+    result.info.has_secondary = true;
+    return result;
   }
-  else if (stress >= 1.F && !has_primary && has_secondary) {
-    string_utils::replace__(result, constants::stress::kSecondary,
+  else if (stress >= 1.F && !info.has_primary && info.has_secondary) {
+    string_utils::replace__(result.phonemes, constants::stress::kSecondary,
                                   {constants::stress::kPrimary});  
+    result.info.has_primary = true;
+    result.info.has_secondary = false;
   }
-  else if (stress > 1.F && !has_primary && !has_secondary && has_vowel) {
-    return restress(std::u32string(1, constants::stress::kPrimary) + result);
+  else if (stress > 1.F && !info.has_primary && !info.has_secondary && info.has_vowel) {
+    result.phonemes = restress(std::u32string(1, constants::stress::kPrimary) + phonemes);
+    result.info.has_primary = true;
+    return result;
   }
 
+  // Stress marks are not deciding phonemes, but a trailing one may have been removed
+  if (info.last & ending::kStress)
+    result.info = analyze(result.phonemes);
   return result;
 }
 
@@ -0,0 +1,68 @@
+#include <phonemis/phonemizer/syllable_index.h>
+#include <algorithm>
+
+namespace phonemis::phonemizer {
+
+SyllableIndex::SyllableIndex() : nodes_(1) {}
+
+SyllableIndex::SyllableIndex(std::vector<std::pair<std::string_view, std::u32string_view>> entries)
+  : nodes_(1) {
+  std::erase_if(entries, [](const auto& entry) {
+    const auto& [text, phonemes] = entry;
+    return text.empty() || text.size() > static_cast<size_t>(constants::kMaxSyllabeLength) ||
+           phonemes.empty() || phonemes.size() >= kNoStress ||
+           std::any_of(text.begin(), text.end(), [](char c) { return c < 'a' || c > 'z'; });
+  });
+  std::sort(entries.begin(), entries.end());
+  entries.erase(std::unique(entries.begin(), entries.end(),
+                            [](const auto& a, const auto& b) { return a.first == b.first; }),
+                entries.end());
+
+  syllables_.reserve(entries.size());
+  build(0, entries, 0, entries.size(), 0);
+}
+
+void SyllableIndex::build(uint32_t node,
+                          const std::vector<std::pair<std::string_view, std::u32string_view>>& entries,
+                          size_t begin,
+                          size_t end,
+                          size_t depth) {
+  // The key equal to the shared prefix sorts first
+  if (begin < end && entries[begin].first.size() == depth) {
+    const auto& [text, phonemes] = entries[begin];
+    const size_t primary = phonemes.find(constants::stress::kPrimary);
+
+    Syllable syllable;
+    syllable.offset = static_cast<uint32_t>(phonemes_.size());
+    syllable.no_phonemes = static_cast<uint16_t>(phonemes.size());
+    syllable.primary = primary != std::u32string_view::npos ? static_cast<uint16_t>(primary) : kNoStress;
+    syllable.silent_e = text.back() == 'e' &&
+                        constants::language::kConsonants.find(phonemes.back()) != std::u32string::npos;
+    phonemes_ += phonemes;
+
+    nodes_[node].syllable = static_cast<uint32_t>(syllables_.size());
+    syllables_.push_back(syllable);
+    begin++;
+  }
+
+  // Allocate the children next to each other, then fill their subtries
+  std::vector<size_t> groups;
+  for (size_t i = begin; i < end; i++) {
+    const uint32_t letter = entries[i].first[depth] - 'a';
+    if (groups.empty() || entries[groups.back()].first[depth] != entries[i].first[depth])
+      groups.push_back(i);
+    nodes_[node].children |= uint32_t(1) << letter;
+  }
+  if (groups.empty())
+    return;
+
+  const auto first_child = static_cast<uint32_t>(nodes_.size());
+  nodes_[node].first_child = first_child;
+  nodes_.resize(nodes_.size() + groups.size());
+  for (size_t g = 0; g < groups.size(); g++) {
+    const size_t group_end = g + 1 < groups.size() ? groups[g + 1] : end;
+    build(first_child + static_cast<uint32_t>(g), entries, groups[g], group_end, depth + 1);
+  }
+}
+
+} // namespace phonemis::phonemizer
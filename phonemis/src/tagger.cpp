@@ -1,13 +1,26 @@
 #include <phonemis/tagger/tagger.h>
+#include <phonemis/tagger/constants.h>
 #include <phonemis/utilities/io_utils.h>
+#include <phonemis/utilities/thread_pool.h>
 #include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <functional>
 #include <filesystem>
 #include <fstream>
+#include <limits>
+#include <numeric>
 #include <stdexcept>
 
 namespace phonemis::tagger {
 
-Tagger::Tagger(const std::string& hmm_data_path) {
+namespace {
+// Log-probability assigned to missing emissions and transitions
+const double kLogEpsilon = std::log(constants::kEpsilon);
+} // namespace
+
+Tagger::Tagger(const std::string& hmm_data_path, Config config)
+	: config_(config) {
 	// Load the input JSON file
 	nlohmann::json json_obj = utilities::io_utils::load_json(hmm_data_path);
 
@@ -22,111 +35,598 @@ Tagger::Tagger(const std::string& hmm_data_path) {
 	// Load start probabilities
   // We can simultaneously load all the possible tags here, since
   // all the tags must appear in start_prob field of the JSON file.
+	utilities::FlatHashMap<std::string, TagIndex> tag_indices;
 	for (auto& item : json_obj["start_prob"].items()) {
-		const Tag tag = item.key();
-    tags_.insert(tag);
-		start_probs_[tag] = item.value().get<double>();
+		tag_indices[item.key()] = static_cast<TagIndex>(tags_.size());
+		tags_.emplace_back(item.key());
+		start_scores_.push_back(std::log(item.value().get<double>()));
 	}
 
 	// Load emission probabilities
+  // Emissions are inverted into word -> tags rows, since the tagger always
+  // queries all the tags for a single word at once.
 	for (auto& tag_item : json_obj["emission"].items()) {
-		const Tag tag = tag_item.key();
+		const auto* tag_index = tag_indices.find(tag_item.key());
 		const auto& inner = tag_item.value();
-		if (!inner.is_object()) continue;
+		if (tag_index == nullptr || !inner.is_object()) continue;
 		for (auto& w : inner.items()) {
-			emission_probs_[tag][w.key()] = w.value().get<double>();
+			emission_scores_[w.key()].emplace_back(*tag_index, std::log(w.value().get<double>()));
 		}
 	}
+	for (auto& [word, row] : emission_scores_)
+		std::sort(row.begin(), row.end());
 
 	// Load transition probabilities
+	transition_scores_.assign(tags_.size() * tags_.size(), kLogEpsilon);
 	for (auto& tag_item : json_obj["transition"].items()) {
-		const Tag tag = tag_item.key();
+		const auto* prev_index = tag_indices.find(tag_item.key());
 		const auto& inner = tag_item.value();
-		if (!inner.is_object()) continue;
+		if (prev_index == nullptr || !inner.is_object()) continue;
 		for (auto& t : inner.items()) {
-			transition_probs_[tag][t.key()] = t.value().get<double>();
+			const auto* curr_index = tag_indices.find(t.key());
+			if (curr_index == nullptr) continue;
+			transition_scores_[*prev_index * tags_.size() + *curr_index] = std::log(t.value().get<double>());
 		}
 	}
+
+	if (config_.prefix_cache_bytes > 0)
+		prefix_cache_ = std::make_unique<PrefixCache>(config_.prefix_cache_bytes);
+}
+
+void Workspace::clear() {
+	*this = Workspace();
 }
 
-void Tagger::tag(std::vector<tokenizer::Token> &sentence) const {
-  // A workaround for zero probability
-  constexpr double EPSILON = 1e-6;
+void Tagger::tag(std::vector<tokenizer::Token>& sentence) const {
+	thread_local Workspace workspace;
+	tag(sentence, workspace);
+}
 
+void Tagger::tag(std::vector<tokenizer::Token>& sentence, Workspace& workspace) const {
 	if (sentence.empty()) {
 		return;
 	}
 
+	// Anchor-split decoding processes the segments separately
+	if (config_.mode == Mode::ANCHOR_SPLIT) {
+		tag_segments(sentence, workspace);
+		return;
+	}
+
+	// Long sentences are decoded in chunks on multiple threads
+	if (config_.mode == Mode::VITERBI && sentence.size() >= config_.parallel_threshold) {
+		tag_chunks(sentence, workspace);
+		return;
+	}
+
 	// Viterbi tables
+  // Columns are stored one after another in flat arrays (see Workspace).
+  // Scores are kept as log-probabilities, so that long sentences do not underflow.
   // back_pointer table allows to reconstruct the optimal path in the state (tag) graph.
-	std::vector<std::unordered_map<Tag, double>> 
-    v(sentence.size()); // v[t][state] -> probability
-	std::vector<std::unordered_map<Tag, Tag>> 
-    back_pointer(sentence.size());  // back_pointer[t][state] -> previous_state
+	auto& offsets = workspace.offsets;
+	auto& states = workspace.states;
+	auto& emit = workspace.emit;
+	Workspace::ensure(offsets, sentence.size() + 1);
+	Workspace::ensure(states, 0);
+	Workspace::ensure(emit, 0);
+	offsets[0] = 0;
 
-	// Initialization
-  // Calculates probabilities for the first word in the sentence.
-	for (const auto& tag : tags_) {
-		double start_p = start_probs_.at(tag);
-    double emit_p = emission_probs_.at(tag).contains(sentence[0].text) 
-                    ? emission_probs_.at(tag).at(sentence[0].text) : EPSILON;
-		v[0][tag] = start_p * emit_p;
+	// Resume from the longest cached prefix of the sentence
+	const size_t no_cached = prefix_cache_ ? prefix_cache_->restore(sentence, workspace) : 0;
 
-		// To make the algorithm less case-sensitive, probe the initial value for lower-case word
-		if (std::isalpha(sentence[0].text[0])) {
-			std::string lowerized = sentence[0].text;
-			lowerized[0] = std::tolower(lowerized[0]);
-			emit_p = emission_probs_.at(tag).contains(lowerized) 
-                ? emission_probs_.at(tag).at(lowerized) : EPSILON;
-			v[0][tag] = std::max(v[0][tag], start_p * emit_p);
+	// Beam search keeps only a limited number of hypotheses per column.
+  // Greedy decoding is simply a beam search with a single hypothesis.
+	const size_t beam_width = config_.mode == Mode::GREEDY ? 1 :
+	                          config_.mode == Mode::BEAM ? std::max<size_t>(config_.beam_width, 1) : 0;
+
+	// Initialization & recursion
+  // Calculates probabilities for the first word in the sentence and then
+  // processes through the rest of the sentence.
+	for (size_t t = no_cached; t < sentence.size(); ++t) {
+		candidates(sentence[t], t == 0 ? lowerized_first(sentence[0].text, workspace) : nullptr, workspace);
+		states.insert(states.end(), workspace.column_tags.begin(), workspace.column_tags.end());
+		emit.insert(emit.end(), workspace.emit_scores.begin(), workspace.emit_scores.end());
+		offsets[t + 1] = states.size();
+
+		Workspace::ensure(workspace.v, states.size());
+		Workspace::ensure(workspace.back_pointer, states.size());
+		if (workspace.column_tags.size() == 1)
+			workspace.v[offsets[t]] = 0.0;
+		advance(workspace, t);
+
+		if (beam_width > 0) {
+			prune(workspace, offsets[t], beam_width);
+			offsets[t + 1] = states.size();
 		}
 	}
 
-	// Recursion
-  // Processes through the rest of the sentence.
-	for (size_t t = 1; t < sentence.size(); ++t) {
-    const auto& word = sentence[t].text;
+	backtrack(sentence, workspace);
+	if (prefix_cache_)
+		prefix_cache_->store(sentence, no_cached, workspace);
+}
 
-		for (const auto& curr_tag : tags_) {
-      // Helper variables to track the best branch
-			double max_prob = -1.0;
-			Tag best_prev;
+PrefixCacheStats Tagger::prefix_cache_stats() const {
+	return prefix_cache_ ? prefix_cache_->stats() : PrefixCacheStats{};
+}
+
+void Tagger::tag_segments(std::vector<tokenizer::Token>& sentence, Workspace& workspace) const {
+	auto& offsets = workspace.offsets;
+	auto& states = workspace.states;
+	auto& emit = workspace.emit;
+	Workspace::ensure(offsets, sentence.size() + 1);
+	Workspace::ensure(states, 0);
+	Workspace::ensure(emit, 0);
+	offsets[0] = 0;
+
+	// Expand the candidates of all the words upfront, looking for anchors
+  // An anchor is a word with a single candidate tag, which all the paths must go through.
+  // Since its column is renormalized (see advance), the segments between anchors are independent.
+	auto& anchors = workspace.anchors;
+	Workspace::ensure(anchors, 0);
+	for (size_t t = 0; t < sentence.size(); ++t) {
+		candidates(sentence[t], t == 0 ? lowerized_first(sentence[0].text, workspace) : nullptr, workspace);
+		states.insert(states.end(), workspace.column_tags.begin(), workspace.column_tags.end());
+		emit.insert(emit.end(), workspace.emit_scores.begin(), workspace.emit_scores.end());
+		offsets[t + 1] = states.size();
+		if (workspace.column_tags.size() == 1 && t > 0)
+			anchors.push_back(t);
+	}
+	anchors.push_back(sentence.size());
+	Workspace::ensure(workspace.v, states.size());
+	Workspace::ensure(workspace.back_pointer, states.size());
+	for (size_t t = 0; t < sentence.size(); ++t) {
+		if (offsets[t + 1] - offsets[t] == 1)
+			workspace.v[offsets[t]] = 0.0;
+	}
+
+	// Group the segments into tasks
+  // Each task covers the columns between two anchors (the latter included),
+  // merged together until they reach a reasonable size.
+	auto& tasks = workspace.tasks;
+	Workspace::ensure(tasks, 0);
+	size_t task_begin = 0;
+	for (size_t anchor : anchors) {
+		const size_t task_end = std::min(anchor + 1, sentence.size());
+		if (task_begin < task_end && (task_end - task_begin >= constants::kMinSegmentTaskLength || task_end == sentence.size())) {
+			tasks.emplace_back(task_begin, task_end);
+			task_begin = task_end;
+		}
+	}
+
+	// Forward pass - independent for each task
+  // Tasks write disjoint ranges of the Viterbi tables, which makes them safe to run concurrently.
+	auto run_task = [this, &workspace](size_t idx) {
+		const auto [begin, end] = workspace.tasks[idx];
+		for (size_t t = begin; t < end; ++t)
+			advance(workspace, t);
+	};
+
+	if (sentence.size() >= config_.parallel_threshold && tasks.size() > 1)
+		utilities::ThreadPool::shared().parallel_for(tasks.size(), run_task);
+	else {
+		for (size_t idx = 0; idx < tasks.size(); ++idx)
+			run_task(idx);
+	}
+
+	backtrack(sentence, workspace);
+}
+
+void Tagger::tag_chunks(std::vector<tokenizer::Token>& sentence, Workspace& workspace) const {
+	auto& offsets = workspace.offsets;
+	auto& states = workspace.states;
+	auto& emit = workspace.emit;
+	Workspace::ensure(offsets, sentence.size() + 1);
+	Workspace::ensure(states, 0);
+	Workspace::ensure(emit, 0);
+	offsets[0] = 0;
 
-      double emit_p = emission_probs_.at(curr_tag).contains(word) 
-                    ? emission_probs_.at(curr_tag).at(word) : EPSILON;
+	for (size_t t = 0; t < sentence.size(); ++t) {
+		candidates(sentence[t], t == 0 ? lowerized_first(sentence[0].text, workspace) : nullptr, workspace);
+		states.insert(states.end(), workspace.column_tags.begin(), workspace.column_tags.end());
+		emit.insert(emit.end(), workspace.emit_scores.begin(), workspace.emit_scores.end());
+		offsets[t + 1] = states.size();
+	}
+	Workspace::ensure(workspace.v, states.size());
+	Workspace::ensure(workspace.back_pointer, states.size());
+
+	// Split the sentence into chunks, one per thread (unless configured otherwise)
+	auto& pool = utilities::ThreadPool::shared();
+	const size_t max_chunks = config_.parallel_chunks > 0 ? config_.parallel_chunks : pool.size();
+	const size_t no_chunks = std::clamp<size_t>(sentence.size() / constants::kMinChunkLength, 1, max_chunks);
+	auto& chunks = workspace.tasks;
+	Workspace::ensure(chunks, 0);
+	for (size_t k = 0; k < no_chunks; ++k)
+		chunks.emplace_back(sentence.size() * k / no_chunks, sentence.size() * (k + 1) / no_chunks);
+
+	// Forward pass - independent for each chunk
+  // Only the first chunk starts from the actual initial state. The others start from
+  // a guessed column (emission scores only) and are corrected by the fix-up pass below.
+	auto run_chunk = [this, &workspace](size_t k) {
+		const auto [begin, end] = workspace.tasks[k];
+		if (k > 0) {
+			std::copy(workspace.emit.begin() + workspace.offsets[begin],
+			          workspace.emit.begin() + workspace.offsets[begin + 1],
+			          workspace.v.begin() + workspace.offsets[begin]);
+			normalize(workspace, begin);
+		}
+		for (size_t t = k > 0 ? begin + 1 : begin; t < end; ++t) {
+			advance(workspace, t);
+			normalize(workspace, t);
+		}
+	};
+	pool.parallel_for(no_chunks, run_chunk);
+
+	// Fix-up pass
+  // Recomputes the columns of each chunk from the (now correct) end of the preceding one.
+  // Viterbi paths quickly merge, so after a few columns the recomputed scores become
+  // exactly equal to the guessed ones - all the following columns are then already correct.
+  // In the worst case, the entire chunk is recomputed, which still gives the exact result.
+	auto& previous = workspace.column_scores;
+	for (size_t k = 1; k < no_chunks; ++k) {
+		const auto [begin, end] = chunks[k];
+		for (size_t t = begin; t < end; ++t) {
+			const auto column_begin = workspace.v.begin() + offsets[t];
+			const auto column_end = workspace.v.begin() + offsets[t + 1];
+			Workspace::ensure(previous, offsets[t + 1] - offsets[t]);
+			std::copy(column_begin, column_end, previous.begin());
+
+			advance(workspace, t);
+			normalize(workspace, t);
+			if (std::equal(column_begin, column_end, previous.begin()))
+				break;
+		}
+	}
+
+	backtrack(sentence, workspace);
+}
+
+void Tagger::normalize(Workspace& workspace, size_t t) const {
+	const auto column_begin = workspace.v.begin() + workspace.offsets[t];
+	const auto column_end = workspace.v.begin() + workspace.offsets[t + 1];
+	const double max_score = *std::max_element(column_begin, column_end);
+	for (auto it = column_begin; it != column_end; ++it)
+		*it -= max_score;
+}
+
+void Tagger::advance(Workspace& workspace, size_t t) const {
+	const auto& offsets = workspace.offsets;
+	const auto& states = workspace.states;
+	const auto& emit = workspace.emit;
+	auto& v = workspace.v;
+	auto& back_pointer = workspace.back_pointer;
+
+	const size_t begin = offsets[t];
+	const size_t end = offsets[t + 1];
+
+	// Renormalization
+  // A column with a single state is passed by all the paths, so its score is fixed to 0
+  // (by the caller, when the column is created). This way, the following columns do not
+  // depend on the actual values of the preceding ones.
+	const bool is_single = end - begin == 1;
 
-			for (const auto& prev_tag : tags_) {
-        double trans_p = transition_probs_.at(prev_tag).contains(curr_tag)
-                          ? transition_probs_.at(prev_tag).at(curr_tag) : EPSILON;
-				double prob = v[t - 1][prev_tag] * trans_p * emit_p;
+	// Initialization
+	if (t == 0) {
+		for (size_t i = begin; i < end; ++i) {
+			if (!is_single) v[i] = start_scores_[states[i]] + emit[i];
+			back_pointer[i] = 0;
+		}
+	}
+	// Recursion
+  // Only the candidate tags of neighbouring words are combined, which in sparse mode
+  // reduces the cost from no_tags^2 to a product of (usually tiny) candidate counts.
+	else {
+		const size_t prev_begin = offsets[t - 1];
+		const size_t prev_end = offsets[t];
 
-				if (prob > max_prob) {
-					max_prob = prob;
-					best_prev = prev_tag;
+		for (size_t i = begin; i < end; ++i) {
+			const TagIndex curr_tag = states[i];
+
+      // Helper variables to track the best branch
+			double max_score = -std::numeric_limits<double>::infinity();
+			uint32_t best_prev = 0;
+
+			for (size_t j = prev_begin; j < prev_end; ++j) {
+				double score = v[j] + transition_score(states[j], curr_tag);
+				if (score > max_score) {
+					max_score = score;
+					best_prev = static_cast<uint32_t>(j - prev_begin);
 				}
 			}
 
-			v[t][curr_tag] = max_prob;
-			back_pointer[t][curr_tag] = best_prev;
+			if (!is_single) v[i] = max_score + emit[i];
+			back_pointer[i] = best_prev;
 		}
 	}
+}
+
+void Tagger::backtrack(std::vector<tokenizer::Token>& sentence, Workspace& workspace) const {
+	const auto& offsets = workspace.offsets;
+	const auto& v = workspace.v;
 
 	// Termination
   // Selects the most probable final tag.
   // The other tags are selected by backtracking through the saved path.
 	size_t last_idx = sentence.size() - 1;
-	auto best_it = std::max_element(tags_.begin(), tags_.end(), [&](const auto& a, const auto& b) {
-			return v[last_idx][a] < v[last_idx][b];
-	});
+	auto best_it = std::max_element(v.begin() + offsets[last_idx], v.begin() + offsets[last_idx + 1]);
+	size_t slot = std::distance(v.begin() + offsets[last_idx], best_it);
 
 	// Backtracking path
-	Tag current_tag = *best_it;
-	sentence[last_idx].tag = current_tag;
+	for (size_t t = last_idx; ; --t) {
+		sentence[t].tag = tags_[workspace.states[offsets[t] + slot]];
+		if (t == 0) break;
+		slot = workspace.back_pointer[offsets[t] + slot];
+	}
+}
 
-	for (size_t t = last_idx; t > 0; --t) {
-		current_tag = back_pointer[t][current_tag];
-		sentence[t - 1].tag = current_tag;
+void Tagger::tag_batch(std::vector<std::vector<tokenizer::Token>>& sentences) const {
+	thread_local Workspace workspace;
+	tag_batch(sentences, workspace);
+}
+
+void Tagger::tag_batch(std::vector<std::vector<tokenizer::Token>>& sentences, Workspace& workspace) const {
+	// Only the exact Viterbi has a fixed, branch-free recursion which can be vectorized.
+  // Other modes simply process the sentences one by one, as well as all the modes with the prefix cache.
+	if (config_.mode != Mode::VITERBI || prefix_cache_) {
+		for (auto& sentence : sentences)
+			tag(sentence, workspace);
+		return;
+	}
+
+	// Group the sentences by length
+  // Neighbouring sentences in the sorted order share a batch, which keeps the padding low.
+  // Long sentences are decoded in parallel chunks instead (see tag_chunks).
+	auto& order = workspace.lanes_order;
+	Workspace::ensure(order, 0);
+	for (auto& sentence : sentences) {
+		if (sentence.size() >= config_.parallel_threshold)
+			tag(sentence, workspace);
+		else if (!sentence.empty())
+			order.push_back(&sentence);
+	}
+	std::sort(order.begin(), order.end(), [](const auto* a, const auto* b) {
+		return a->size() != b->size() ? a->size() < b->size() : a < b;
+	});
+
+	for (size_t i = 0; i < order.size(); i += constants::kBatchLanes) {
+		const size_t no_lanes = std::min(constants::kBatchLanes, order.size() - i);
+
+		// Mostly empty batches are not worth the padding
+		if (no_lanes < constants::kMinBatchLanes) {
+			for (size_t j = i; j < i + no_lanes; ++j)
+				tag(*order[j], workspace);
+		}
+		else
+			tag_lanes(order.data() + i, no_lanes, workspace);
+	}
+}
+
+void Tagger::tag_lanes(std::vector<tokenizer::Token>* const* lanes, size_t no_lanes,
+                       Workspace& workspace) const {
+	constexpr size_t B = constants::kBatchLanes;
+	const size_t no_tags = tags_.size();
+
+	// The lanes are sorted by length, so the last one is the longest
+	const size_t length = lanes[no_lanes - 1]->size();
+
+	// Viterbi tables in structure of arrays layout
+  // Each entry [tag * B + lane] keeps the value for a given tag of a given sentence (lane).
+	auto& v = workspace.lanes_v;
+	auto& v_next = workspace.lanes_v_next;
+	auto& emit = workspace.lanes_emit;
+	auto& back_pointer = workspace.lanes_back_pointer;  // [t][tag][lane]
+	Workspace::ensure(v, no_tags * B);
+	Workspace::ensure(v_next, no_tags * B);
+	Workspace::ensure(emit, no_tags * B);
+	Workspace::ensure(back_pointer, length * no_tags * B);
+
+	// Helper function - emission scores of all the lanes at given position
+  // Lanes which are shorter than `t` (padding) get zero scores, which are never read back.
+	auto fill_emissions = [&](size_t t) {
+		std::fill(emit.begin(), emit.end(), 0.0);
+		for (size_t b = 0; b < no_lanes; ++b) {
+			const auto& sentence = *lanes[b];
+			if (t >= sentence.size()) continue;
+
+			candidates(sentence[t], t == 0 ? lowerized_first(sentence[0].text, workspace) : nullptr, workspace);
+			for (size_t tag = 0; tag < no_tags; ++tag)
+				emit[tag * B + b] = workspace.emit_scores[tag];
+		}
+	};
+
+	// Helper function - termination & backtracking
+  // Lanes ending at position `t` are resolved right away, since their
+  // columns are going to be overwritten by the padding.
+	auto terminate = [&](size_t t) {
+		for (size_t b = 0; b < no_lanes; ++b) {
+			auto& sentence = *lanes[b];
+			if (sentence.size() - 1 != t) continue;
+
+			size_t best_tag = 0;
+			for (size_t tag = 1; tag < no_tags; ++tag) {
+				if (v[tag * B + b] > v[best_tag * B + b])
+					best_tag = tag;
+			}
+
+			for (size_t k = t; ; --k) {
+				sentence[k].tag = tags_[best_tag];
+				if (k == 0) break;
+				best_tag = back_pointer[(k * no_tags + best_tag) * B + b];
+			}
+		}
+	};
+
+	// Initialization
+	fill_emissions(0);
+	for (size_t tag = 0; tag < no_tags; ++tag) {
+		for (size_t b = 0; b < B; ++b)
+			v[tag * B + b] = start_scores_[tag] + emit[tag * B + b];
+	}
+	terminate(0);
+
+	// Recursion
+  // The innermost loops run over lanes with no data-dependent branches,
+  // which allows the compiler to map them onto SIMD instructions.
+	for (size_t t = 1; t < length; ++t) {
+		fill_emissions(t);
+		TagIndex* bp_column = back_pointer.data() + t * no_tags * B;
+
+		for (size_t curr_tag = 0; curr_tag < no_tags; ++curr_tag) {
+			double max_score[B];
+			TagIndex best_prev[B];
+			std::fill(max_score, max_score + B, -std::numeric_limits<double>::infinity());
+			std::fill(best_prev, best_prev + B, TagIndex{0});
+
+			for (size_t prev_tag = 0; prev_tag < no_tags; ++prev_tag) {
+				const double trans = transition_score(static_cast<TagIndex>(prev_tag), static_cast<TagIndex>(curr_tag));
+				const double* v_prev = v.data() + prev_tag * B;
+				for (size_t b = 0; b < B; ++b) {
+					const double score = v_prev[b] + trans;
+					const bool better = score > max_score[b];
+					max_score[b] = better ? score : max_score[b];
+					best_prev[b] = better ? static_cast<TagIndex>(prev_tag) : best_prev[b];
+				}
+			}
+
+			for (size_t b = 0; b < B; ++b) {
+				v_next[curr_tag * B + b] = max_score[b] + emit[curr_tag * B + b];
+				bp_column[curr_tag * B + b] = best_prev[b];
+			}
+		}
+		std::swap(v, v_next);
+		terminate(t);
+	}
+}
+
+void Tagger::prune(Workspace& workspace, size_t column_begin, size_t beam_width) const {
+	auto& states = workspace.states;
+	auto& emit = workspace.emit;
+	auto& v = workspace.v;
+	auto& back_pointer = workspace.back_pointer;
+
+	const auto column_begin_it = v.begin() + column_begin;
+	const size_t column_size = v.size() - column_begin;
+
+	// Score threshold
+  // A hypothesis survives if it is within the margin from the best one,
+  // and if it is among the best `beam_width` hypotheses in the column.
+	double threshold = *std::max_element(column_begin_it, v.end());
+	threshold -= config_.mode == Mode::BEAM ? config_.beam_margin : std::numeric_limits<double>::infinity();
+	if (column_size > beam_width) {
+		auto& scores = workspace.beam_scores;
+		Workspace::ensure(scores, column_size);
+		std::copy(column_begin_it, v.end(), scores.begin());
+		std::nth_element(scores.begin(), scores.begin() + (beam_width - 1), scores.end(), std::greater<>());
+		threshold = std::max(threshold, scores[beam_width - 1]);
+	}
+
+	// Hypotheses tied with the threshold only fill the remaining places in the beam
+	size_t no_ties_allowed = beam_width - std::count_if(column_begin_it, v.end(),
+	                                                    [threshold](double score) { return score > threshold; });
+
+	// Compact the column, preserving the order of surviving hypotheses
+	size_t kept = column_begin;
+	for (size_t i = column_begin; i < v.size(); ++i) {
+		if (v[i] < threshold)
+			continue;
+		if (v[i] == threshold) {
+			if (no_ties_allowed == 0) continue;
+			--no_ties_allowed;
+		}
+		states[kept] = states[i];
+		emit[kept] = emit[i];
+		v[kept] = v[i];
+		back_pointer[kept] = back_pointer[i];
+		++kept;
+	}
+	states.resize(kept);
+	emit.resize(kept);
+	v.resize(kept);
+	back_pointer.resize(kept);
+}
+
+const std::string* Tagger::lowerized_first(const std::string& first_word,
+                                           Workspace& workspace) const {
+	if (!std::isalpha(static_cast<unsigned char>(first_word[0])))
+		return nullptr;
+
+	workspace.lowerized.assign(first_word);
+	workspace.lowerized[0] = std::tolower(static_cast<unsigned char>(first_word[0]));
+	return &workspace.lowerized;
+}
+
+void Tagger::bind(tokenizer::Vocabulary& vocabulary) {
+	vocabulary_ = &vocabulary;
+	for (const auto& [word, row] : emission_scores_) {
+		const tokenizer::WordId id = vocabulary.intern(word);
+		if (id >= emission_rows_.size())
+			emission_rows_.resize(id + 1, nullptr);
+		emission_rows_[id] = &row;
+	}
+}
+
+const Tagger::EmissionRow* Tagger::emission_row(const tokenizer::Token& token) const {
+	// Tokens found in the bound vocabulary are resolved by their id
+	if (token.id != tokenizer::Vocabulary::kUnknown && vocabulary_ != nullptr)
+		return token.id < emission_rows_.size() ? emission_rows_[token.id] : nullptr;
+	return emission_row(token.text);
+}
+
+const Tagger::EmissionRow* Tagger::emission_row(const std::string& word) const {
+	return emission_scores_.find(word);
+}
+
+void Tagger::candidates(const tokenizer::Token& token,
+                        const std::string* alt_word,
+                        Workspace& workspace) const {
+	const EmissionRow* rows[] = {
+		emission_row(token),
+		alt_word != nullptr ? emission_row(*alt_word) : nullptr
+	};
+
+	auto& tags = workspace.column_tags;
+	auto& emit_scores = workspace.emit_scores;
+
+	// Full expansion
+  // Used by the exact Viterbi and for unknown words, which could take any of the tags.
+	if (config_.mode != Mode::SPARSE_VITERBI && config_.mode != Mode::ANCHOR_SPLIT || rows[0] == nullptr && rows[1] == nullptr) {
+		Workspace::ensure(tags, tags_.size());
+		Workspace::ensure(emit_scores, tags_.size());
+		std::iota(tags.begin(), tags.end(), TagIndex{0});
+		std::fill(emit_scores.begin(), emit_scores.end(), kLogEpsilon);
+		for (const auto* row : rows) {
+			if (row == nullptr) continue;
+			for (const auto& [tag_idx, score] : *row)
+				emit_scores[tag_idx] = std::max(emit_scores[tag_idx], score);
+		}
+		return;
+	}
+
+	// Sparse expansion
+  // Merges both (sorted) rows, keeping the better score for tags present in both of them.
+	static const EmissionRow empty_row;
+	const auto& a = rows[0] != nullptr ? *rows[0] : empty_row;
+	const auto& b = rows[1] != nullptr ? *rows[1] : empty_row;
+	Workspace::ensure(tags, 0);
+	Workspace::ensure(emit_scores, 0);
+	size_t i = 0, j = 0;
+	while (i < a.size() || j < b.size()) {
+		TagIndex tag_idx;
+		double score = kLogEpsilon;
+		if (j == b.size() || i < a.size() && a[i].first < b[j].first) {
+			tag_idx = a[i].first;
+			score = std::max(score, a[i++].second);
+		}
+		else if (i == a.size() || b[j].first < a[i].first) {
+			tag_idx = b[j].first;
+			score = std::max(score, b[j++].second);
+		}
+		else {
+			tag_idx = a[i].first;
+			score = std::max({score, a[i++].second, b[j++].second});
+		}
+		tags.push_back(tag_idx);
+		emit_scores.push_back(score);
 	}
 }
 
-} // namespace phonemis::tagger
\ No newline at end of file
+} // namespace phonemis::tagger
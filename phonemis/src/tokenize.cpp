@@ -43,14 +43,6 @@ void process_chunk(const std::string& chunk,
 	// Edge case - an empty word ("")
 	if (chunk.empty()) return;
 
-	// Special word set lookup
-	// If an entire chunk is a special word, we should return it without
-	// further divisions.
-	if (constants::kSpecialWords.count(to_lower(chunk))) {
-		tokens.push_back({chunk});
-		return;
-	}
-
 	// Find first special character
 	size_t special_pos = std::string::npos;
 	rules::Separation rule;
@@ -63,11 +55,20 @@ void process_chunk(const std::string& chunk,
 	}
 
 	// If no special character found, it's a simple token (an entire word)
+	// (special words are kept whole as well, so they are looked up only when it matters).
 	if (special_pos == std::string::npos) {
 		tokens.push_back({chunk, ""});
 		return;
 	}
 
+	// Special word set lookup
+	// If an entire chunk is a special word, we should return it without
+	// further divisions.
+	if (constants::kSpecialWords.contains(to_lower(chunk))) {
+		tokens.push_back({chunk});
+		return;
+	}
+
 	// If special character was found, then apply rules and divide into subwords
 	std::string left = chunk.substr(0, special_pos);
 	std::string right = chunk.substr(special_pos + 1);
@@ -146,7 +147,7 @@ void process_raw_word(const std::string& raw_word,
 }
 } // namespace
 
-std::vector<Token> tokenize(const std::string& text) {
+std::vector<Token> tokenize(const std::string& text, const Vocabulary* vocabulary) {
 	// A resulting list of tokens
 	std::vector<Token> tokens;
 
@@ -190,6 +191,12 @@ std::vector<Token> tokenize(const std::string& text) {
 	if (!tokens.empty())
 		tokens.front().is_first = true;
 
+	// Look the tokens up, once for all the later stages
+	if (vocabulary != nullptr) {
+		for (auto& token : tokens)
+			token.id = vocabulary->find(token.text);
+	}
+
 	return tokens;
 }
 
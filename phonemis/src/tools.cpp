@@ -24,8 +24,8 @@ std::string normalize_unicode(const std::string& text) {
 	std::string converted;
 	converted.reserve(text.size());	// The conversion should be at least 1:1
 	for (char32_t c : u32text) {
-		if (kForeignToLatin.contains(c))
-			converted.append(kForeignToLatin.at(c));
+		if (const auto* latin = kForeignToLatin.find(c))
+			converted.append(*latin);
 		else if (c < 128)
 			converted.push_back(static_cast<char>(c));
 	}
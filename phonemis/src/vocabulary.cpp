@@ -0,0 +1,18 @@
+#include <phonemis/tokenizer/vocabulary.h>
+#include <stdexcept>
+
+namespace phonemis::tokenizer {
+
+WordId Vocabulary::intern(std::string_view word) {
+  if (const WordId* id = ids_.find(word))
+    return *id;
+  if (words_.size() >= kUnknown)
+    throw std::invalid_argument("Vocabulary is full");
+
+  const auto id = static_cast<WordId>(words_.size());
+  words_.emplace_back(word);
+  ids_.try_emplace(std::string_view(words_.back()), id);
+  return id;
+}
+
+} // namespace phonemis::tokenizer
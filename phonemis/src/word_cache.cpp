@@ -0,0 +1,184 @@
+#include <phonemis/phonemizer/word_cache.h>
+#include <algorithm>
+#include <bit>
+#include <functional>
+
+namespace phonemis::phonemizer {
+
+using constants::cache::kNoShards;
+using constants::cache::kL1Size;
+using constants::cache::kSketchDepth;
+using constants::cache::kSketchWidthRatio;
+using constants::cache::kSketchResetRatio;
+
+namespace {
+// Maximal value of a sketch counter
+constexpr uint8_t kMaxCount = 15;
+
+// Source of the cache ids, 0 is reserved for the empty L1 entries
+std::atomic<uint64_t> next_id = 1;
+
+uint64_t mix(uint64_t key) {
+  // splitmix64 finalizer
+  key = (key ^ (key >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  key = (key ^ (key >> 27)) * 0x94d049bb133111ebULL;
+  return key ^ (key >> 31);
+}
+} // namespace
+
+WordCache::WordCache(size_t capacity)
+  : id_(next_id++),
+    shard_capacity_(std::max<size_t>(1, (capacity + kNoShards - 1) / kNoShards)),
+    sketch_width_(std::max<size_t>(64, shard_capacity_ * kSketchWidthRatio)),
+    shards_(std::make_unique<Shard[]>(kNoShards)) {
+  for (size_t i = 0; i < kNoShards; i++) {
+    shards_[i].entries.reserve(shard_capacity_);
+    shards_[i].clock.reserve(shard_capacity_);
+    shards_[i].sketch.assign(kSketchDepth * sketch_width_, 0);
+  }
+}
+
+std::optional<Pronunciation> WordCache::find(const Key& key) {
+  const KeyView key_view = view(key);
+  Shard& key_shard = shard(key_view.hash);
+
+  // Per-thread front first - no locking at all
+  const L1Entry& front = l1()[key_view.hash % kL1Size];
+  if (front.owner == id_ && front.hash == key_view.hash &&
+      front.context == key_view.context && front.word == key_view.word) {
+    key_shard.no_hits.fetch_add(1, std::memory_order_relaxed);
+    key_shard.no_l1_hits.fetch_add(1, std::memory_order_relaxed);
+    return front.pronunciation;
+  }
+
+  std::optional<Pronunciation> result;
+  {
+    std::lock_guard<std::mutex> lock(key_shard.mutex);
+    record_access(key_shard, key_view.hash);
+
+    const auto it = key_shard.entries.find(key_view);
+    if (it == key_shard.entries.end()) {
+      key_shard.no_misses.fetch_add(1, std::memory_order_relaxed);
+      return std::nullopt;
+    }
+    it->second.referenced = true;
+    result = it->second.pronunciation;
+  }
+
+  key_shard.no_hits.fetch_add(1, std::memory_order_relaxed);
+  fill_l1(key_view, *result);
+  return result;
+}
+
+void WordCache::insert(const Key& key, const Pronunciation& pronunciation) {
+  const KeyView key_view = view(key);
+  Shard& key_shard = shard(key_view.hash);
+
+  // Frequently missed words are served by the thread front, even if the shared part rejects them
+  fill_l1(key_view, pronunciation);
+
+  std::lock_guard<std::mutex> lock(key_shard.mutex);
+  auto& entries = key_shard.entries;
+  auto& clock = key_shard.clock;
+
+  // Already inserted by another thread
+  if (entries.find(key_view) != entries.end())
+    return;
+
+  StoredKey stored_key = {std::string(key_view.word), key_view.context, key_view.hash};
+  if (entries.size() < shard_capacity_) {
+    clock.push_back(entries.emplace(std::move(stored_key), Entry{pronunciation}).first);
+    return;
+  }
+
+  // Pick the victim - the first entry not hit since the hand last passed it
+  auto& hand = key_shard.hand;
+  while (clock[hand]->second.referenced) {
+    clock[hand]->second.referenced = false;
+    hand = (hand + 1) % clock.size();
+  }
+
+  // Admit the new entry only if it is more popular than the victim
+  if (estimate(key_shard, key_view.hash) <= estimate(key_shard, clock[hand]->first.hash)) {
+    key_shard.no_rejections.fetch_add(1, std::memory_order_relaxed);
+    return;
+  }
+
+  entries.erase(clock[hand]);
+  clock[hand] = entries.emplace(std::move(stored_key), Entry{pronunciation}).first;
+  hand = (hand + 1) % clock.size();
+  key_shard.no_evictions.fetch_add(1, std::memory_order_relaxed);
+}
+
+WordCacheStats WordCache::stats() const {
+  WordCacheStats stats;
+  for (size_t i = 0; i < kNoShards; i++) {
+    Shard& s = shards_[i];
+    stats.no_hits += s.no_hits.load(std::memory_order_relaxed);
+    stats.no_l1_hits += s.no_l1_hits.load(std::memory_order_relaxed);
+    stats.no_misses += s.no_misses.load(std::memory_order_relaxed);
+    stats.no_evictions += s.no_evictions.load(std::memory_order_relaxed);
+    stats.no_rejections += s.no_rejections.load(std::memory_order_relaxed);
+
+    std::lock_guard<std::mutex> lock(s.mutex);
+    stats.no_entries += s.entries.size();
+  }
+  return stats;
+}
+
+uint64_t WordCache::context(const Key& key) {
+  // Layout: tag id (bits 0-7), presence flags (bits 8-9), vowel_next (bit 10), base stress (bits 32-63)
+  uint64_t context = key.tag.id();
+  if (key.base_stress.has_value())
+    context |= (uint64_t(1) << 8) | (uint64_t(std::bit_cast<uint32_t>(*key.base_stress)) << 32);
+  if (key.vowel_next.has_value())
+    context |= (uint64_t(1) << 9) | (uint64_t(*key.vowel_next) << 10);
+  return context;
+}
+
+WordCache::KeyView WordCache::view(const Key& key) {
+  const uint64_t key_context = context(key);
+  const size_t hash = mix(std::hash<std::string_view>()(key.word) ^ mix(key_context));
+  return {key.word, key_context, hash};
+}
+
+WordCache::L1& WordCache::l1() {
+  static thread_local L1 front;
+  return front;
+}
+
+void WordCache::fill_l1(const KeyView& key, const Pronunciation& pronunciation) const {
+  L1Entry& front = l1()[key.hash % kL1Size];
+  front.owner = id_;
+  front.hash = key.hash;
+  front.context = key.context;
+  front.word.assign(key.word);
+  front.pronunciation = pronunciation;
+}
+
+size_t WordCache::sketch_index(size_t hash, size_t row) const {
+  return row * sketch_width_ + mix(hash + row * 0x9e3779b97f4a7c15ULL) % sketch_width_;
+}
+
+void WordCache::record_access(Shard& shard, size_t hash) const {
+  for (size_t row = 0; row < kSketchDepth; row++) {
+    uint8_t& count = shard.sketch[sketch_index(hash, row)];
+    count = std::min<uint8_t>(count + 1, kMaxCount);
+  }
+
+  // Halve the counts periodically, so that the popularity reflects the recent traffic
+  if (++shard.no_accesses >= kSketchResetRatio * shard_capacity_) {
+    for (auto& count : shard.sketch)
+      count >>= 1;
+    shard.no_accesses = 0;
+  }
+}
+
+uint8_t WordCache::estimate(const Shard& shard, size_t hash) const {
+  uint8_t count = kMaxCount;
+  for (size_t row = 0; row < kSketchDepth; row++)
+    count = std::min(count, shard.sketch[sketch_index(hash, row)]);
+  return count;
+}
+
+} // namespace phonemis::phonemizer
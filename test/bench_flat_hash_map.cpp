@@ -0,0 +1,106 @@
+#include <phonemis/preprocessor/tools.h>
+#include <phonemis/tokenizer/tokenize.h>
+#include <phonemis/utilities/flat_hash_map.h>
+#include <phonemis/utilities/io_utils.h>
+#include <phonemis/utilities/string_utils.h>
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+using namespace phonemis;
+
+namespace {
+// The container previously used by the lexicon (transparent std::hash lookups)
+struct StdStringHash {
+  using is_transparent = void;
+  size_t operator()(std::string_view str) const noexcept { return std::hash<std::string_view>()(str); }
+};
+using StdMap = std::unordered_map<std::string, std::u32string, StdStringHash, std::equal_to<>>;
+using FlatMap = utilities::FlatHashMap<std::string, std::u32string>;
+
+// Pointer to the found value, regardless of the container
+const std::u32string* find(const StdMap& map, std::string_view key) {
+  const auto it = map.find(key);
+  return it != map.end() ? &it->second : nullptr;
+}
+const std::u32string* find(const FlatMap& map, std::string_view key) { return map.find(key); }
+} // namespace
+
+// Hash map benchmark
+// Compares the flat hash map with std::unordered_map on the lexicon's workload:
+// dictionary words as keys, looked up with hits, misses and the words of a corpus.
+int main(int argc, char** argv) {
+  std::string LEXICON_DATA_PATH = argc > 1 ? argv[1] : "../data/dictionaries/us_merged.json";
+  std::string CORPUS_PATH = argc > 2 ? argv[2] : "../data/reference.txt";
+  constexpr int NO_REPEATS = 10;
+
+  // Load the dictionary entries
+  const auto json_obj = utilities::io_utils::load_json(LEXICON_DATA_PATH);
+  std::vector<std::pair<std::string, std::u32string>> entries;
+  for (const auto& item : json_obj.items()) {
+    if (item.value().is_string())
+      entries.emplace_back(item.key(), utilities::string_utils::utf8_to_u32string(item.value().get<std::string>()));
+  }
+
+  // Query sets - the words in random order, the words with an extra ending, and the corpus' tokens
+  std::mt19937 rng(42);
+  std::vector<std::string> hits, misses, corpus_words;
+  for (const auto& [word, phonemes] : entries) {
+    hits.push_back(word);
+    misses.push_back(word + "qz");
+  }
+  std::shuffle(hits.begin(), hits.end(), rng);
+  std::shuffle(misses.begin(), misses.end(), rng);
+
+  std::ifstream corpus(CORPUS_PATH);
+  std::string line;
+  while (std::getline(corpus, line)) {
+    auto verbalized = preprocessor::verbalize_numbers(preprocessor::normalize_unicode(line));
+    for (const auto& sentence : preprocessor::split_sentences(verbalized))
+      for (const auto& token : tokenizer::tokenize(sentence))
+        corpus_words.push_back(token.text);
+  }
+
+  // Runs the benchmarks of a single container type
+  auto run = [&]<typename Map>(const std::string& name, Map& map) {
+    auto start = std::chrono::steady_clock::now();
+    for (const auto& [word, phonemes] : entries)
+      map[word] = phonemes;
+    double build_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << std::left << std::setw(20) << name << std::right << std::fixed << std::setprecision(1)
+              << "build: " << 1e9 * build_seconds / entries.size() << " ns/entry\n";
+
+    for (const auto* queries : {&hits, &misses, &corpus_words}) {
+      if (queries->empty())
+        continue;
+      size_t no_found = 0;
+      start = std::chrono::steady_clock::now();
+      for (int r = 0; r < NO_REPEATS; r++)
+        for (const auto& query : *queries)
+          no_found += find(map, query) != nullptr;
+      double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+      const char* set_name = queries == &hits ? "hits" : queries == &misses ? "misses" : "corpus";
+      std::cout << "  " << std::left << std::setw(10) << set_name << std::right << std::setw(8)
+                << std::setprecision(1) << 1e9 * seconds / (NO_REPEATS * queries->size()) << " ns/lookup"
+                << std::setw(10) << std::setprecision(2) << 100.0 * no_found / (NO_REPEATS * queries->size())
+                << "% found\n";
+    }
+  };
+
+  std::cout << "Dictionary: " << entries.size() << " entries, corpus: " << corpus_words.size() << " tokens\n";
+  StdMap std_map;
+  run("std::unordered_map", std_map);
+  FlatMap flat_map;
+  run("FlatHashMap", flat_map);
+  std::cout << "FlatHashMap table: " << flat_map.memory_bytes() / 1024 << " KiB\n";
+
+  return 0;
+}
@@ -0,0 +1,96 @@
+#include <phonemis/preprocessor/tools.h>
+#include <phonemis/tagger/tagger.h>
+#include <phonemis/tokenizer/tokenize.h>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace phonemis;
+
+// Tagging modes benchmark
+// Reports the speed of each decoding mode together with its agreement
+// with the exact Viterbi on a reference corpus.
+int main(int argc, char** argv) {
+  std::string TAGGER_DATA_PATH = "../data/hmm.json";
+  std::string CORPUS_PATH = argc > 1 ? argv[1] : "../data/reference.txt";
+  constexpr int NO_REPEATS = 20;
+
+  // Load & tokenize the corpus
+  std::ifstream corpus(CORPUS_PATH);
+  if (!corpus.is_open()) {
+    std::cerr << "Failed to open corpus: " << CORPUS_PATH << "\n";
+    return 1;
+  }
+
+  std::vector<std::vector<tokenizer::Token>> sentences;
+  size_t no_tokens = 0;
+  std::string line;
+  while (std::getline(corpus, line)) {
+    auto verbalized = preprocessor::verbalize_numbers(preprocessor::normalize_unicode(line));
+    for (const auto& sentence : preprocessor::split_sentences(verbalized)) {
+      sentences.push_back(tokenizer::tokenize(sentence));
+      no_tokens += sentences.back().size();
+    }
+  }
+
+  // Runs a single configuration, returning the tagged corpus
+  auto run = [&](const std::string& name, tagger::Config config,
+                 const std::vector<std::vector<tokenizer::Token>>* reference,
+                 bool batched = false) {
+    tagger::Tagger tagger(TAGGER_DATA_PATH, config);
+    auto tagged = sentences;
+
+    auto start = std::chrono::steady_clock::now();
+    for (int r = 0; r < NO_REPEATS; r++) {
+      if (batched)
+        tagger.tag_batch(tagged);
+      else
+        for (auto& sentence : tagged)
+          tagger.tag(sentence);
+    }
+    auto end = std::chrono::steady_clock::now();
+    double seconds = std::chrono::duration<double>(end - start).count();
+
+    size_t no_agreed = 0;
+    for (size_t i = 0; reference != nullptr && i < tagged.size(); i++)
+      for (size_t j = 0; j < tagged[i].size(); j++)
+        no_agreed += tagged[i][j].tag == (*reference)[i][j].tag;
+    double agreement = reference != nullptr ? 100.0 * no_agreed / no_tokens : 100.0;
+
+    std::cout << std::left << std::setw(20) << name
+              << std::right << std::setw(14) << std::fixed << std::setprecision(0)
+              << NO_REPEATS * no_tokens / seconds << " tokens/s"
+              << std::setw(10) << std::setprecision(2) << agreement << "% agreement\n";
+
+    // Prefix cache metrics of a single pass over the corpus
+    if (config.prefix_cache_bytes > 0) {
+      tagger::Tagger fresh_tagger(TAGGER_DATA_PATH, config);
+      auto fresh_tagged = sentences;
+      for (auto& sentence : fresh_tagged)
+        fresh_tagger.tag(sentence);
+      auto stats = fresh_tagger.prefix_cache_stats();
+      std::cout << "  prefix cache: " << std::setprecision(2) << 100.0 * stats.hit_rate() << "% columns reused, "
+                << stats.no_hits << "/" << stats.no_hits + stats.no_misses << " sentences resumed, "
+                << stats.no_entries << " entries, " << stats.memory_bytes / 1024 << " KiB\n";
+    }
+    return tagged;
+  };
+
+  std::cout << "Corpus: " << sentences.size() << " sentences, " << no_tokens << " tokens\n";
+  auto reference = run("viterbi", {tagger::Mode::VITERBI}, nullptr);
+  run("viterbi (batch)", {tagger::Mode::VITERBI}, &reference, true);
+  tagger::Config cached_config = {tagger::Mode::VITERBI};
+  cached_config.prefix_cache_bytes = 16 << 20;
+  run("viterbi (cache)", cached_config, &reference);
+  run("sparse viterbi", {tagger::Mode::SPARSE_VITERBI}, &reference);
+  run("anchor split", {tagger::Mode::ANCHOR_SPLIT}, &reference);
+  for (size_t width : {1, 2, 4, 8})
+    run("beam (k=" + std::to_string(width) + ")", {tagger::Mode::BEAM, width}, &reference);
+  run("beam (k=8, m=5)", {tagger::Mode::BEAM, 8, 5.0}, &reference);
+  run("greedy", {tagger::Mode::GREEDY}, &reference);
+
+  return 0;
+}
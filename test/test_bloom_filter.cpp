@@ -0,0 +1,68 @@
+#include <phonemis/utilities/bloom_filter.h>
+#include <phonemis/utilities/flat_hash_map.h>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace phonemis;
+
+// Bloom filter test
+// The lexicon relies on the filter never rejecting an inserted key, and on it rejecting most of the others.
+int main() {
+  constexpr size_t BITS_PER_KEY = 12;     // As in the lexicon (see constants::lexicon::kFilterBitsPerKey)
+  constexpr size_t NO_QUERIES = 1000000;
+  constexpr double MAX_FALSE_POSITIVE_RATE = 0.015;   // Loose bound, the expected rate is about 0.5%
+  bool ok = true;
+
+  // Default constructed filter accepts everything
+  utilities::BloomFilter empty_filter;
+  bool empty_ok = true;
+  for (uint64_t hash : {uint64_t(0), uint64_t(1), UINT64_MAX})
+    empty_ok &= empty_filter.may_contain(hash);
+  std::cout << "[default filter accepts everything] " << (empty_ok ? "OK" : "FAILED") << "\n";
+  ok &= empty_ok;
+
+  // Key hashes of different quality - random (splitmix64 of the index), consecutive integers, and hashed words
+  auto random_hash = [](size_t i) {
+    uint64_t hash = i * 0x9e3779b97f4a7c15ULL;
+    hash = (hash ^ (hash >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    hash = (hash ^ (hash >> 27)) * 0x94d049bb133111ebULL;
+    return hash ^ (hash >> 31);
+  };
+  auto consecutive_hash = [](size_t i) { return static_cast<uint64_t>(i); };
+  auto word_hash = [](size_t i) {
+    const std::string word = "word" + std::to_string(i);
+    return utilities::hash_bytes(word.data(), word.size());
+  };
+
+  auto run = [&](const std::string& name, auto make_hash, size_t no_keys) {
+    utilities::BloomFilter filter(no_keys, BITS_PER_KEY);
+    for (size_t i = 0; i < no_keys; i++)
+      filter.insert(make_hash(i));
+
+    // No false negatives
+    bool filter_ok = true;
+    for (size_t i = 0; i < no_keys; i++)
+      filter_ok &= filter.may_contain(make_hash(i));
+
+    // False positives, measured on the keys following the inserted ones
+    size_t no_false_positives = 0;
+    for (size_t i = no_keys; i < no_keys + NO_QUERIES; i++)
+      no_false_positives += filter.may_contain(make_hash(i));
+    const double rate = static_cast<double>(no_false_positives) / NO_QUERIES;
+    filter_ok &= no_keys < 1000 || rate <= MAX_FALSE_POSITIVE_RATE;
+
+    std::cout << "[" << name << ", " << no_keys << " keys] " << (filter_ok ? "OK" : "FAILED")
+              << " (false positives: " << std::fixed << std::setprecision(3) << 100.0 * rate << "%)\n";
+    ok &= filter_ok;
+  };
+
+  for (size_t no_keys : {size_t(0), size_t(1), size_t(100), size_t(60000), size_t(1000000)}) {
+    run("random hashes", random_hash, no_keys);
+    run("consecutive hashes", consecutive_hash, no_keys);
+    run("word hashes", word_hash, no_keys);
+  }
+
+  return ok ? 0 : 1;
+}
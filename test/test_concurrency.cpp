@@ -0,0 +1,124 @@
+#include <phonemis/pipeline.h>
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace phonemis;
+
+// Concurrency stress test
+// Many threads process the corpus through a single shared pipeline, each in a different order,
+// and must get the same results as a sequential run. Build with -fsanitize=thread to also check
+// for data races, e.g.:
+//   g++ -std=c++20 -g -O1 -fsanitize=thread -I../phonemis/include test_concurrency.cpp ../phonemis/src/*.cpp -lpthread
+int main(int argc, char** argv) {
+  std::string TAGGER_DATA_PATH = "../data/hmm.json";
+  std::string LEXICON_DATA_PATH = "../data/dictionaries/us_merged.json";
+  std::string CORPUS_PATH = "../data/reference.txt";
+  const size_t NO_THREADS = argc > 1 ? std::stoul(argv[1]) : 8;
+  constexpr int NO_ROUNDS = 3;
+
+  std::ifstream corpus(CORPUS_PATH);
+  if (!corpus.is_open()) {
+    std::cerr << "Failed to open corpus: " << CORPUS_PATH << "\n";
+    return 1;
+  }
+  std::vector<std::string> lines;
+  std::string line;
+  while (std::getline(corpus, line))
+    lines.push_back(line);
+
+  // Sequential results of an uncached pipeline with given tagger configuration
+  auto sequential = [&](const tagger::Config& tagger_config) {
+    const Pipeline pipeline(Lang::EN_US, TAGGER_DATA_PATH, LEXICON_DATA_PATH, tagger_config);
+    std::vector<std::u32string> results;
+    for (const auto& text : lines)
+      results.push_back(pipeline.process(text));
+    return results;
+  };
+
+  // Processes the corpus on given number of threads sharing the pipeline, returns the number of mismatches
+  auto run = [&](const Pipeline& pipeline, size_t no_threads, const std::vector<std::u32string>& expected) {
+    std::atomic<size_t> no_mismatches = 0;
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < no_threads; t++) {
+      threads.emplace_back([&, t]() {
+        for (int round = 0; round < NO_ROUNDS; round++)
+          for (size_t i = 0; i < lines.size(); i++) {
+            const size_t index = (i + t * 7) % lines.size();
+            if (pipeline.process(lines[index]) != expected[index])
+              no_mismatches++;
+          }
+      });
+    }
+    for (auto& thread : threads)
+      thread.join();
+    return no_mismatches.load();
+  };
+
+  // Configurations exercising the shared state - the caches, the hot words and the shared thread pool
+  const auto temp_directory = std::filesystem::temp_directory_path();
+  const auto cache_filepath = (temp_directory / "phonemis_test_concurrency_cache.bin").string();
+  const auto hot_words_filepath = (temp_directory / "phonemis_test_concurrency_hot_words.txt").string();
+  std::filesystem::remove(cache_filepath);
+  {
+    std::ofstream hot_words_file(hot_words_filepath);
+    for (const char* word : {"the", "of", "and", "to", "a", "in", "is", "it", "you", "that"})
+      hot_words_file << word << "\n";
+  }
+
+  tagger::Config cached_tagger_config;
+  cached_tagger_config.prefix_cache_bytes = 1 << 20;
+  phonemizer::Config cached_phonemizer_config;
+  cached_phonemizer_config.cache_capacity = 64;   // Small enough to keep evicting
+  cached_phonemizer_config.cache_filepath = cache_filepath;
+  cached_phonemizer_config.hot_words_filepath = hot_words_filepath;
+  tagger::Config parallel_tagger_config;
+  parallel_tagger_config.parallel_threshold = 8;
+
+  struct Setup {
+    std::string name;
+    tagger::Config tagger_config;
+    phonemizer::Config phonemizer_config;
+  };
+  const std::vector<Setup> setups = {
+    {"default", {}, {}},
+    {"caches", cached_tagger_config, cached_phonemizer_config},
+    {"parallel decoding", parallel_tagger_config, {}},
+    {"beam", {tagger::Mode::BEAM}, {}},
+  };
+
+  bool ok = true;
+  for (const auto& setup : setups) {
+    const Pipeline pipeline(Lang::EN_US, TAGGER_DATA_PATH, LEXICON_DATA_PATH, setup.tagger_config, setup.phonemizer_config);
+    const size_t no_mismatches = run(pipeline, NO_THREADS, sequential(setup.tagger_config));
+    const bool setup_ok = no_mismatches == 0;
+    std::cout << "[shared pipeline, " << setup.name << ", " << NO_THREADS << " threads] "
+              << (setup_ok ? "OK" : "FAILED (" + std::to_string(no_mismatches) + " mismatches)") << "\n";
+    ok &= setup_ok;
+  }
+  std::filesystem::remove(cache_filepath);
+  std::filesystem::remove(hot_words_filepath);
+
+  // Throughput of a shared pipeline, compared to a single thread
+  const Pipeline pipeline(Lang::EN_US, TAGGER_DATA_PATH, LEXICON_DATA_PATH);
+  const auto expected = sequential({});
+  double single_thread_rate = 0.0;
+  for (size_t no_threads : {size_t(1), NO_THREADS}) {
+    const auto start = std::chrono::steady_clock::now();
+    run(pipeline, no_threads, expected);
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    const double rate = no_threads * NO_ROUNDS * lines.size() / seconds;
+    if (no_threads == 1)
+      single_thread_rate = rate;
+    std::cout << "  " << no_threads << " threads: " << std::fixed << std::setprecision(0) << rate << " lines/s ("
+              << std::setprecision(2) << rate / single_thread_rate << "x)\n";
+  }
+
+  return ok ? 0 : 1;
+}
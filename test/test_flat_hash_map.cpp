@@ -0,0 +1,189 @@
+#include <phonemis/utilities/flat_hash_map.h>
+#include <algorithm>
+#include <iostream>
+#include <random>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+using namespace phonemis;
+
+// Flat hash map test
+// Runs random sequences of insertions, erasures, lookups and reserves on the flat hash tables
+// and on the standard containers, and compares the results after each operation.
+// Build it also with -DPHONEMIS_FLAT_HASH_NO_SSE2, to test the portable group probing.
+namespace {
+// Poor hash - maps the keys to a few values, so that the probe sequences get long
+// and the control bytes of different keys collide
+struct CollidingHash {
+  size_t operator()(int key) const noexcept { return static_cast<size_t>(key % 13) * 0x9E3779B97F4A7C15ULL; }
+};
+
+// Checks that the flat table holds exactly the entries of the reference container
+template <typename Table, typename Reference>
+bool same_entries(const Table& table, const Reference& reference) {
+  if (table.size() != reference.size() || table.empty() != reference.empty())
+    return false;
+  size_t no_iterated = 0;
+  for (const auto& entry : table) {
+    no_iterated++;
+    if constexpr (requires { entry.second; }) {
+      const auto it = reference.find(entry.first);
+      if (it == reference.end() || it->second != entry.second)
+        return false;
+    }
+    else if (!reference.contains(entry)) {
+      return false;
+    }
+  }
+  return no_iterated == reference.size();
+}
+
+// Random operations on a map, `make_key` maps random numbers to the keys
+template <typename Map, typename MakeKey>
+bool test_map(MakeKey make_key, size_t no_keys, size_t no_operations, uint32_t seed) {
+  using Key = typename Map::key_type;
+  Map map;
+  std::unordered_map<Key, int> reference;
+  std::mt19937 rng(seed);
+  bool ok = true;
+
+  for (size_t i = 0; i < no_operations && ok; i++) {
+    const Key key = make_key(rng() % no_keys);
+    const int value = static_cast<int>(rng());
+    switch (rng() % 16) {
+      case 0: case 1: case 2: {   // Insertion, never overwriting
+        const auto [found, inserted] = map.try_emplace(key, value);
+        const auto [it, reference_inserted] = reference.try_emplace(key, value);
+        ok &= inserted == reference_inserted && *found == it->second;
+        break;
+      }
+      case 3: {
+        map[key] = value;
+        reference[key] = value;
+        break;
+      }
+      case 4: {
+        const auto [found, inserted] = map.insert({key, value});
+        const auto [it, reference_inserted] = reference.insert({key, value});
+        ok &= inserted == reference_inserted && *found == it->second;
+        break;
+      }
+      case 5: case 6: case 7: case 8: {
+        ok &= map.erase(key) == (reference.erase(key) == 1);
+        break;
+      }
+      case 9: {
+        map.reserve(reference.size() + rng() % 64);
+        break;
+      }
+      case 10: {   // Rare full reset
+        if (rng() % 64 == 0) {
+          map.clear();
+          reference.clear();
+        }
+        break;
+      }
+      case 11: {   // Copies and moves must hold the same entries
+        if (rng() % 32 == 0) {
+          Map copy = map;
+          ok &= same_entries(copy, reference);
+          Map moved = std::move(copy);
+          ok &= same_entries(moved, reference) && copy.empty();
+          map = moved;
+        }
+        break;
+      }
+      default: {
+        const auto* found = map.find(key);
+        const auto it = reference.find(key);
+        ok &= (found != nullptr) == (it != reference.end()) && map.contains(key) == (found != nullptr);
+        if (found != nullptr && it != reference.end())
+          ok &= *found == it->second && map.at(key) == it->second;
+        break;
+      }
+    }
+    if (i % 256 == 0)
+      ok &= same_entries(map, reference);
+  }
+  return ok && same_entries(map, reference);
+}
+
+// Random operations on a set
+template <typename Set>
+bool test_set(size_t no_keys, size_t no_operations, uint32_t seed) {
+  using Key = typename Set::key_type;
+  Set set;
+  std::unordered_set<Key> reference;
+  std::mt19937 rng(seed);
+  bool ok = true;
+
+  for (size_t i = 0; i < no_operations && ok; i++) {
+    const Key key = static_cast<Key>(rng() % no_keys);
+    switch (rng() % 4) {
+      case 0: ok &= set.insert(key).second == reference.insert(key).second; break;
+      case 1: ok &= set.erase(key) == (reference.erase(key) == 1); break;
+      default: ok &= set.contains(key) == reference.contains(key); break;
+    }
+  }
+  return ok && same_entries(set, reference);
+}
+
+// Erases most of the entries and inserts new ones, so that the rehashes find the tables full of tombstones
+template <typename Map>
+bool test_tombstones(size_t no_rounds) {
+  Map map;
+  std::unordered_map<int, int> reference;
+  int next_key = 0;
+  bool ok = true;
+  for (size_t round = 0; round < no_rounds; round++) {
+    for (int i = 0; i < 100; i++, next_key++) {
+      map.try_emplace(next_key, next_key);
+      reference.try_emplace(next_key, next_key);
+    }
+    for (int key = std::max(next_key - 105, 0); key < next_key - 5; key++) {
+      ok &= map.erase(key);
+      reference.erase(key);
+    }
+    ok &= same_entries(map, reference) && map.memory_bytes() <= 1024 * (sizeof(std::pair<int, int>) + 1);
+  }
+  return ok;
+}
+} // namespace
+
+int main() {
+  bool ok = true;
+  auto report = [&](const std::string& name, bool test_ok) {
+    std::cout << "[" << name << "] " << (test_ok ? "OK" : "FAILED") << "\n";
+    ok &= test_ok;
+  };
+
+#ifdef PHONEMIS_FLAT_HASH_SSE2
+  std::cout << "Group probing: SSE2\n";
+#else
+  std::cout << "Group probing: portable\n";
+#endif
+
+  auto int_key = [](uint32_t x) { return static_cast<int>(x); };
+  auto string_key = [](uint32_t x) { return "key" + std::to_string(x) + std::string(x % 24, 'x'); };
+  for (size_t no_keys : {size_t(10), size_t(300), size_t(5000)}) {
+    const std::string suffix = ", " + std::to_string(no_keys) + " keys";
+    report("int map" + suffix, test_map<utilities::FlatHashMap<int, int>>(int_key, no_keys, 200000, 1));
+    report("string map" + suffix, test_map<utilities::FlatHashMap<std::string, int>>(string_key, no_keys, 200000, 2));
+    report("colliding map" + suffix,
+           test_map<utilities::FlatHashMap<int, int, CollidingHash>>(int_key, no_keys, 50000, 3));
+    report("int set" + suffix, test_set<utilities::FlatHashSet<int>>(no_keys, 200000, 4));
+  }
+  report("tombstone rehashes", test_tombstones<utilities::FlatHashMap<int, int>>(1000));
+
+  // Transparent lookups of the string keys
+  utilities::FlatHashMap<std::string, int> words = {{"the", 1}, {"cloud", 2}};
+  bool transparent_ok = words.find(std::string_view("cloud")) != nullptr && *words.find("the") == 1 &&
+                        words.find(std::string_view("clou")) == nullptr;
+  report("transparent lookups", transparent_ok);
+
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,198 @@
+#include <phonemis/phonemizer/lexicon.h>
+#include <phonemis/tokenizer/vocabulary.h>
+#include <phonemis/utilities/string_utils.h>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <optional>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace phonemis;
+using namespace phonemis::utilities;
+using phonemizer::Lang;
+
+// Lexicon golden test
+// Compares Lexicon::get over the words x contexts (language, tag, base stress, vowel_next) of the expected
+// file against the phonemizations recorded there, so that the rewrites of the lexicon internals (special words,
+// suffix and stress rules, id-resolved probes, views of the entries) can be checked for unchanged results.
+// The lexicon is a small synthetic one, holding the listed words and their stems.
+// Run with --update to rewrite the expected phonemizations of the listed words (after an intended change).
+//
+// Expected file format: a tab-separated table with a header line, one word per line, one context per column.
+// The contexts are labelled as language/tag/base_stress/vowel_next, "-" standing for no value, and
+// "=" in a cell stands for the phonemization of the first context.
+namespace {
+struct Context {
+  Lang language;
+  tagger::Tag tag;
+  std::optional<float> base_stress;
+  std::optional<bool> vowel_next;
+  std::string label;
+};
+
+Context make_context(Lang language, tagger::Tag tag, std::optional<float> base_stress, std::optional<bool> vowel_next) {
+  std::ostringstream label;
+  label << (language == Lang::EN_GB ? "gb" : "us") << "/" << (tag == tagger::Tag::NONE ? "-" : tag.name()) << "/";
+  if (base_stress.has_value())
+    label << base_stress.value();
+  else
+    label << "-";
+  label << "/" << (vowel_next.has_value() ? (vowel_next.value() ? "1" : "0") : "-");
+  return {language, tag, base_stress, vowel_next, label.str()};
+}
+
+std::vector<Context> make_contexts() {
+  using tagger::Tag;
+  const std::optional<float> no_stress;
+  const std::optional<bool> no_vowel_next;
+  std::vector<Context> contexts;
+
+  // Tags alone
+  for (Tag tag : {Tag::NONE, Tag::NN, Tag::NNS, Tag::NNP, Tag::NNPS, Tag::VB, Tag::VBD, Tag::VBG, Tag::VBN,
+                  Tag::VBP, Tag::VBZ, Tag::DT, Tag::IN, Tag::TO, Tag::RB, Tag::PRP, Tag::JJ, Tag::CD, Tag::ADD})
+    contexts.push_back(make_context(Lang::EN_US, tag, no_stress, no_vowel_next));
+
+  // Base stresses, across the thresholds of the stress rules
+  for (float stress : {-2.0F, -1.0F, -0.5F, 0.0F, 0.5F, 1.0F, 2.0F})
+    contexts.push_back(make_context(Lang::EN_US, Tag::NN, stress, no_vowel_next));
+  for (float stress : {-1.0F, 0.0F, 1.0F}) {
+    contexts.push_back(make_context(Lang::EN_US, Tag::NNP, stress, no_vowel_next));
+    contexts.push_back(make_context(Lang::EN_US, Tag::VBD, stress, no_vowel_next));
+  }
+
+  // Followed by a vowel or not (which changes the special words)
+  for (Tag tag : {Tag::NONE, Tag::DT, Tag::IN, Tag::TO, Tag::NN, Tag::VBP})
+    for (bool vowel_next : {false, true})
+      contexts.push_back(make_context(Lang::EN_US, tag, no_stress, vowel_next));
+  for (float stress : {0.0F, 1.0F})
+    contexts.push_back(make_context(Lang::EN_US, Tag::VBP, stress, true));
+
+  // British English suffixes
+  for (Tag tag : {Tag::NONE, Tag::NNS, Tag::NNP, Tag::VBD, Tag::VBG, Tag::VBZ})
+    contexts.push_back(make_context(Lang::EN_GB, tag, no_stress, no_vowel_next));
+  contexts.push_back(make_context(Lang::EN_GB, Tag::NN, 1.0F, no_vowel_next));
+
+  return contexts;
+}
+
+std::vector<std::string> split(const std::string& line) {
+  std::vector<std::string> fields;
+  for (size_t begin = 0, end; begin <= line.size(); begin = end + 1) {
+    end = std::min(line.find('\t', begin), line.size());
+    fields.push_back(line.substr(begin, end - begin));
+  }
+  return fields;
+}
+} // namespace
+
+int main(int argc, char* argv[]) {
+  std::string LEXICON_DATA_PATH = "../data/test_lexicon.json";
+  std::string EXPECTED_PATH = "../data/test_lexicon_expected.tsv";
+  const bool update = argc > 1 && std::string(argv[1]) == "--update";
+
+  const auto contexts = make_contexts();
+  std::string header = "word";
+  for (const auto& context : contexts)
+    header += "\t" + context.label;
+
+  // Load the words and their expected phonemizations (one row per word, one column per context)
+  std::vector<std::string> comments, words;
+  std::vector<std::vector<std::u32string>> expected;
+  {
+    std::ifstream file(EXPECTED_PATH);
+    if (!file)
+      throw std::runtime_error("Cannot open " + EXPECTED_PATH);
+    std::string line;
+    while (std::getline(file, line) && line.starts_with("#"))
+      comments.push_back(line);
+    if (line != header && !update) {
+      std::cout << "[lexicon golden] FAILED (the contexts of " << EXPECTED_PATH << " differ from the test's)\n";
+      return 1;
+    }
+    while (std::getline(file, line)) {
+      auto fields = split(line);
+      words.push_back(fields[0]);
+      expected.emplace_back();
+      for (size_t i = 1; i < fields.size(); i++)
+        expected.back().push_back(fields[i] == "=" ? expected.back().front() : string_utils::utf8_to_u32string(fields[i]));
+      if (!update && expected.back().size() != contexts.size())
+        throw std::runtime_error("Unexpected number of columns for \"" + fields[0] + "\" in " + EXPECTED_PATH);
+    }
+  }
+
+  phonemizer::Lexicon us_lexicon(Lang::EN_US, LEXICON_DATA_PATH);
+  phonemizer::Lexicon gb_lexicon(Lang::EN_GB, LEXICON_DATA_PATH);
+  auto lexicon_of = [&](const Context& context) -> const phonemizer::Lexicon& {
+    return context.language == Lang::EN_GB ? gb_lexicon : us_lexicon;
+  };
+
+  if (update) {
+    std::ofstream file(EXPECTED_PATH);
+    for (const auto& comment : comments)
+      file << comment << "\n";
+    file << header << "\n";
+    for (const auto& word : words) {
+      file << word;
+      std::u32string first;
+      for (size_t i = 0; i < contexts.size(); i++) {
+        const auto& context = contexts[i];
+        const auto phonemes = lexicon_of(context).get(word, context.tag, context.base_stress, context.vowel_next);
+        if (i == 0)
+          first = phonemes;
+        file << "\t" << (i > 0 && phonemes == first ? "=" : string_utils::u32string_to_utf8(phonemes));
+      }
+      file << "\n";
+    }
+    std::cout << "Updated " << EXPECTED_PATH << " (" << words.size() << " words, " << contexts.size() << " contexts)\n";
+    return 0;
+  }
+
+  // Compares the phonemizations given by `phonemize(word index, context)` against the expected ones
+  bool ok = true;
+  auto check = [&](const std::string& name, const std::function<std::u32string(size_t, const Context&)>& phonemize) {
+    size_t no_mismatches = 0;
+    for (size_t w = 0; w < words.size(); w++)
+      for (size_t i = 0; i < contexts.size(); i++) {
+        const auto phonemes = phonemize(w, contexts[i]);
+        if (phonemes == expected[w][i])
+          continue;
+        if (no_mismatches++ < 10)
+          std::cout << "  " << words[w] << " (" << contexts[i].label << "): "
+                    << string_utils::u32string_to_utf8(phonemes) << ", expected "
+                    << string_utils::u32string_to_utf8(expected[w][i]) << "\n";
+      }
+    std::cout << "[" << name << ", " << words.size() << " words x " << contexts.size() << " contexts] "
+              << (no_mismatches == 0 ? "OK" : "FAILED (" + std::to_string(no_mismatches) + " mismatches)") << "\n";
+    ok &= no_mismatches == 0;
+  };
+
+  // Plain lookups
+  check("lexicon golden", [&](size_t w, const Context& context) {
+    return lexicon_of(context).get(words[w], context.tag, context.base_stress, context.vowel_next);
+  });
+
+  // Lookups resolved by the ids of a bound vocabulary - every other word is interned before the lexicons
+  // are bound (the rest keep kUnknown ids, unless the lexicons intern them)
+  tokenizer::Vocabulary vocabulary;
+  for (size_t w = 0; w < words.size(); w += 2)
+    vocabulary.intern(words[w]);
+  us_lexicon.bind(vocabulary);
+  gb_lexicon.bind(vocabulary);
+  check("lexicon golden, word ids", [&](size_t w, const Context& context) {
+    return lexicon_of(context).pronounce(words[w], context.tag, context.base_stress, context.vowel_next,
+                                         vocabulary.find(words[w])).phonemes;
+  });
+
+  // Lookups served by the hot words, all the listed words being hot
+  phonemizer::Lexicon hot_us_lexicon(Lang::EN_US, LEXICON_DATA_PATH, words);
+  phonemizer::Lexicon hot_gb_lexicon(Lang::EN_GB, LEXICON_DATA_PATH, words);
+  check("lexicon golden, hot words", [&](size_t w, const Context& context) {
+    const auto& lexicon = context.language == Lang::EN_GB ? hot_gb_lexicon : hot_us_lexicon;
+    return lexicon.get(words[w], context.tag, context.base_stress, context.vowel_next);
+  });
+
+  return ok ? 0 : 1;
+}
@@ -1,6 +1,15 @@
 #include <phonemis/pipeline.h>
+#include <phonemis/phonemizer/lexicon_builder.h>
+#include <phonemis/tokenizer/tokenize.h>
 #include <phonemis/utilities/string_utils.h>
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
 #include <iostream>
+#include <span>
+#include <stdexcept>
+#include <thread>
 #include <vector>
 #include <string>
 
@@ -10,6 +19,7 @@ using namespace phonemis::utilities;
 int main() {
   std::string TAGGER_DATA_PATH = "../data/hmm.json";
   std::string LEXICON_DATA_PATH = "../data/dictionaries/us_merged.json";
+  std::string CORPUS_PATH = "../data/reference.txt";
 
   // const std::string text = "I love it! This is the best day of my entire life.";
   const std::string text = "Damian cloud is a real beast! He is the 66th of the raiders!";
@@ -20,5 +30,210 @@ int main() {
   std::cout << "Text: " << text << "\n";
   std::cout << "Phonemes: " << string_utils::u32string_to_utf8(phonemes) << "\n";
 
-  return 0;
+  // Word cache must not change the results, also when it is too small to hold all the words
+  bool ok = true;
+  for (size_t capacity : {size_t(4), size_t(4096)}) {
+    Pipeline cached_pipeline(Lang::EN_US, TAGGER_DATA_PATH, LEXICON_DATA_PATH, {}, {capacity});
+    bool cache_ok = true;
+    for (int pass = 0; pass < 2; pass++)
+      cache_ok &= cached_pipeline.process(text) == phonemes;
+    std::cout << "[word cache, " << capacity << " entries] " << (cache_ok ? "OK" : "FAILED") << "\n";
+    ok &= cache_ok;
+  }
+
+  // Persistent cache must not change the results, and must be reused after a restart
+  const auto cache_filepath = (std::filesystem::temp_directory_path() / "phonemis_test_cache.bin").string();
+  std::filesystem::remove(cache_filepath);
+  bool file_ok = true;
+  for (int restart = 0; restart < 2; restart++) {
+    phonemizer::Config phonemizer_config;
+    phonemizer_config.cache_filepath = cache_filepath;
+    Pipeline cached_pipeline(Lang::EN_US, TAGGER_DATA_PATH, LEXICON_DATA_PATH, {}, phonemizer_config);
+    file_ok &= cached_pipeline.process(text) == phonemes;
+  }
+  // Only the words phonemized by the rules are kept in the file, the dictionary words are not
+  for (size_t expected_hits : {0, 1}) {
+    Phonemizer cached_phonemizer(Lang::EN_US, LEXICON_DATA_PATH, {0, cache_filepath});
+    cached_phonemizer.phonemize("Blorfington", tagger::Tag::NNP, 1.0F, true);
+    cached_phonemizer.phonemize("cloud", tagger::Tag::NN, 1.0F, true);
+    file_ok &= cached_phonemizer.cache_stats().no_file_hits == expected_hits;
+  }
+  std::filesystem::remove(cache_filepath);
+
+  // A key queued more than once (by the threads missing the same word) is stored once,
+  // also when it is committed in the same batch twice
+  for (bool flush_between : {false, true}) {
+    phonemizer::PersistentCache file_cache(cache_filepath, 0);
+    const phonemizer::WordCache::Key key = {"damian", tagger::Tag::NNP, 1.0F, true};
+    file_cache.insert(key, phonemizer::Pronunciation(U"dˈeɪmiən"));
+    if (flush_between)
+      file_cache.flush();
+    file_cache.insert(key, phonemizer::Pronunciation(U"dˈeɪmiən"));
+    file_ok &= file_cache.no_entries() == 1;
+    file_cache.flush();
+    file_ok &= file_cache.no_entries() == 1;
+    std::filesystem::remove(cache_filepath);
+  }
+
+  // Records are shared with the other users of the file once flushed, or once old enough
+  {
+    phonemizer::PersistentCache writer(cache_filepath, 0), reader(cache_filepath, 0);
+    const phonemizer::WordCache::Key key = {"damian", tagger::Tag::NNP, 1.0F, true};
+    const phonemizer::WordCache::Key other_key = {"damian", tagger::Tag::NN, 1.0F, true};
+    writer.insert(key, phonemizer::Pronunciation(U"dˈeɪmiən"));
+    reader.flush();
+    file_ok &= !reader.find(key).has_value();
+    writer.flush();
+    reader.flush();
+    file_ok &= reader.find(key).has_value();
+
+    writer.insert(other_key, phonemizer::Pronunciation(U"dˈeɪmiən"));
+    std::this_thread::sleep_for(std::chrono::milliseconds(phonemizer::constants::cache::kFileFlushMilliseconds));
+    writer.insert({"raiders", tagger::Tag::NNS, 1.0F, true}, phonemizer::Pronunciation(U"ɹˈeɪdɚz"));
+    reader.flush();
+    file_ok &= reader.find(other_key).has_value();
+  }
+  std::filesystem::remove(cache_filepath);
+  std::cout << "[persistent cache] " << (file_ok ? "OK" : "FAILED") << "\n";
+  ok &= file_ok;
+
+  // Hot words must not change the results, whatever their context
+  const auto hot_words_filepath = (std::filesystem::temp_directory_path() / "phonemis_test_hot_words.txt").string();
+  {
+    std::ofstream hot_words_file(hot_words_filepath);
+    for (const char* word : {"the\t100", "is\t50", "cloud\t20", "real", "he", "of", "beast", "raiders", "damian"})
+      hot_words_file << word << "\n";
+  }
+  phonemizer::Config hot_config;
+  hot_config.hot_words_filepath = hot_words_filepath;
+  Pipeline hot_pipeline(Lang::EN_US, TAGGER_DATA_PATH, LEXICON_DATA_PATH, {}, hot_config);
+  Phonemizer phonemizer(Lang::EN_US, LEXICON_DATA_PATH), hot_phonemizer(Lang::EN_US, LEXICON_DATA_PATH, hot_config);
+  bool hot_ok = hot_pipeline.process(text) == phonemes;
+  for (auto tag : {tagger::Tag::NN, tagger::Tag::NNP, tagger::Tag::DT})
+    for (const char* word : {"cloud", "Cloud", "real", "beast", "raiders"})
+      hot_ok &= hot_phonemizer.phonemize(word, tag, 1.0F) == phonemizer.phonemize(word, tag, 1.0F);
+  std::filesystem::remove(hot_words_filepath);
+  std::cout << "[hot words] " << (hot_ok ? "OK" : "FAILED") << "\n";
+  ok &= hot_ok;
+
+  // Views of the lexicon entries must match the copies, which are made only for the modified words
+  bool ref_ok = true;
+  for (auto tag : {tagger::Tag::NN, tagger::Tag::NNP, tagger::Tag::DT})
+    for (const char* word : {"cloud", "Cloud", "clouds", "the", "beast", "raiders"})
+      for (auto base_stress : {std::optional<float>(), std::optional<float>(1.0F)}) {
+        const auto pronunciation = phonemizer.pronounce(word, tag, base_stress, true);
+        const auto ref = phonemizer.pronounce_ref(word, tag, base_stress, true);
+        ref_ok &= ref.phonemes() == pronunciation.phonemes && ref.info() == pronunciation.info;
+      }
+  ref_ok &= !phonemizer.pronounce_ref("cloud", tagger::Tag::NN).owns();
+  std::cout << "[lexicon views] " << (ref_ok ? "OK" : "FAILED") << "\n";
+  ok &= ref_ok;
+
+  // Syllabe index must find exactly the syllabes the dictionary knows, with the same phonemes
+  phonemizer::Lexicon lexicon(Lang::EN_US, LEXICON_DATA_PATH);
+  bool syllables_ok = true;
+  for (std::string_view word : {"damian", "cloud", "beast", "raiders", "xqzt"})
+    for (size_t begin = 0; begin < word.size(); begin++) {
+      std::vector<size_t> sizes;
+      lexicon.syllables().match(word.substr(begin), [&](size_t size, const auto& syllable) {
+        sizes.push_back(size);
+        syllables_ok &= lexicon.syllables().phonemes(syllable) == lexicon.entry(word.substr(begin, size)).phonemes;
+      });
+      std::vector<size_t> expected_sizes;
+      for (size_t size = 1; size <= std::min<size_t>(word.size() - begin, phonemizer::constants::kMaxSyllabeLength); size++)
+        if (lexicon.is_known(word.substr(begin, size)))
+          expected_sizes.push_back(size);
+      syllables_ok &= sizes == expected_sizes;
+    }
+  std::cout << "[syllable index] " << (syllables_ok ? "OK" : "FAILED") << "\n";
+  ok &= syllables_ok;
+
+  // Batched lookups must resolve each word as the exact and then the lower case probe does,
+  // whether the words come with ids of the bound vocabulary or not
+  std::vector<std::string> batch_words;
+  {
+    std::ifstream corpus(CORPUS_PATH);
+    std::string line;
+    while (std::getline(corpus, line))
+      for (const auto& token : tokenizer::tokenize(line))
+        for (const auto& word : {token.text, string_utils::to_lower(token.text),
+                                 string_utils::to_upper(token.text), string_utils::capitalize(token.text)})
+          batch_words.push_back(word);
+  }
+  batch_words.insert(batch_words.end(), {"", "Xqzt", "CLOUD", "Cloud", "NASA"});
+  auto exact_entry = [&](const std::string& word) -> const phonemizer::Pronunciation* {
+    try {
+      return &lexicon.entry(word);
+    } catch (const std::out_of_range&) {
+      return nullptr;
+    }
+  };
+  auto probed_entry = [&](const std::string& word) {
+    const auto* entry = exact_entry(word);
+    return entry != nullptr ? entry : exact_entry(string_utils::to_lower(word));
+  };
+  auto batch_matches = [&](std::span<const tokenizer::WordId> ids) {
+    const std::vector<std::string_view> words(batch_words.begin(), batch_words.end());
+    std::vector<const phonemizer::Pronunciation*> results(words.size());
+    lexicon.find_batch(words, results, ids);
+    bool matches = true;
+    for (size_t i = 0; i < words.size(); i++)
+      matches &= results[i] == probed_entry(batch_words[i]);
+    return matches;
+  };
+  bool batch_ok = batch_matches({});
+
+  // Every other word is interned before the lexicon is bound - the rest keep kUnknown ids,
+  // and the last words are left without ids at all
+  tokenizer::Vocabulary vocabulary;
+  for (size_t i = 0; i < batch_words.size(); i += 2)
+    vocabulary.intern(batch_words[i]);
+  lexicon.bind(vocabulary);
+  std::vector<tokenizer::WordId> ids;
+  size_t no_bound = 0, no_bound_lower = 0;   // The latter resolved by their lower case forms only
+  for (size_t i = 0; i + 3 < batch_words.size(); i++) {
+    ids.push_back(vocabulary.find(batch_words[i]));
+    if (ids.back() == tokenizer::Vocabulary::kUnknown)
+      continue;
+    no_bound++;
+    no_bound_lower += exact_entry(batch_words[i]) == nullptr && probed_entry(batch_words[i]) != nullptr;
+  }
+  batch_ok &= no_bound > 0 && no_bound < ids.size() && no_bound_lower > 0;
+  batch_ok &= batch_matches(ids) && batch_matches({});
+  std::cout << "[batched lookups, " << batch_words.size() << " words] " << (batch_ok ? "OK" : "FAILED") << "\n";
+  ok &= batch_ok;
+
+  // Materialized inflections must be loaded as derived entries, and must not change the results in any context
+  std::vector<std::string> inflected_words;
+  for (const auto& word : batch_words) {
+    const auto lower = string_utils::to_lower(word);
+    for (const char* suffix : {"", "s", "es", "ed", "d", "ing"})
+      inflected_words.push_back(lower + suffix);
+  }
+  std::sort(inflected_words.begin(), inflected_words.end());
+  inflected_words.erase(std::unique(inflected_words.begin(), inflected_words.end()), inflected_words.end());
+  const auto derived_filepath = (std::filesystem::temp_directory_path() / "phonemis_test_derived.json").string();
+  const size_t no_derived = phonemizer::materialize_inflections(Lang::EN_US, LEXICON_DATA_PATH, inflected_words, derived_filepath);
+  phonemizer::Lexicon derived_lexicon(Lang::EN_US, derived_filepath);
+  std::filesystem::remove(derived_filepath);
+  size_t no_loaded = 0;
+  bool derived_ok = no_derived > 0;
+  for (const auto& word : inflected_words) {
+    if (derived_lexicon.derived_entry(word) == nullptr)
+      continue;
+    no_loaded++;
+    for (const auto& variant : {word, string_utils::capitalize(word)})
+      for (auto tag : {tagger::Tag::NN, tagger::Tag::NNS, tagger::Tag::VBD, tagger::Tag::VBG, tagger::Tag::NNP})
+        for (auto base_stress : {std::optional<float>(), std::optional<float>(0.0F), std::optional<float>(1.0F)}) {
+          const auto pronunciation = lexicon.pronounce(variant, tag, base_stress);
+          const auto derived_pronunciation = derived_lexicon.pronounce(variant, tag, base_stress);
+          derived_ok &= derived_pronunciation.phonemes == pronunciation.phonemes &&
+                        derived_pronunciation.info == pronunciation.info;
+        }
+  }
+  derived_ok &= no_loaded > 0;
+  std::cout << "[materialized inflections, " << no_loaded << " entries] " << (derived_ok ? "OK" : "FAILED") << "\n";
+  ok &= derived_ok;
+
+  return ok ? 0 : 1;
 }
\ No newline at end of file
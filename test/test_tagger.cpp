@@ -0,0 +1,215 @@
+#include <phonemis/preprocessor/tools.h>
+#include <phonemis/tagger/streaming_tagger.h>
+#include <phonemis/tagger/tagger.h>
+#include <phonemis/tokenizer/tokenize.h>
+#include <atomic>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace phonemis;
+
+// Heap allocation counter
+// Used to verify that tagging with a warmed up workspace does not allocate.
+static std::atomic<size_t> no_allocations = 0;
+
+void* operator new(std::size_t size) {
+  no_allocations++;
+  if (void* ptr = std::malloc(size)) return ptr;
+  throw std::bad_alloc();
+}
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+void operator delete(void* ptr, std::size_t) noexcept { std::free(ptr); }
+
+int main() {
+  std::string FILEPATH = "../data/hmm.json";
+
+  std::string text = "The old farmer watched them from his porch and remembered the summers of his own childhood. "
+                     "Reading, writing, counting, drawing, singing and playing are the most important activities! "
+                     "Your order number has shipped. I am so proud of me.";
+
+  std::vector<std::vector<tokenizer::Token>> sentences;
+  for (const auto& sentence : preprocessor::split_sentences(text))
+    sentences.push_back(tokenizer::tokenize(sentence));
+
+  tagger::Tagger tagger(FILEPATH);
+  bool ok = true;
+
+  // Tags must round-trip through their string form and resolve their parents
+  bool tags_ok = true;
+  for (size_t id = 0; id < tagger::Tag::COUNT; id++) {
+    tagger::Tag tag(static_cast<tagger::Tag::Id>(id));
+    tags_ok &= tagger::Tag(tag.name()) == tag;
+  }
+  tags_ok &= tagger::Tag("NNPS").parent_tag() == tagger::Tag::NOUN;
+  tags_ok &= tagger::Tag("RBR").parent_tag() == tagger::Tag::ADV;
+  tags_ok &= tagger::Tag("ADD").parent_tag() == tagger::Tag::ADD;
+  tags_ok &= tagger::Tag(tagger::Tag::NNP).is(tagger::TagCategory::PROPER_NOUN);
+  tags_ok &= !tagger::Tag(tagger::Tag::NN).is(tagger::TagCategory::PROPER_NOUN);
+  tags_ok &= tagger::Tag(tagger::Tag::COMMA).is(tagger::TagCategory::PUNCTUATION);
+  std::cout << "[tag ids] " << (tags_ok ? "OK" : "FAILED") << "\n";
+  ok &= tags_ok;
+
+  // Batched tagging must match sentence by sentence tagging
+  auto batched = sentences;
+  tagger.tag_batch(batched);
+  for (size_t i = 0; i < sentences.size(); i++) {
+    tagger.tag(sentences[i]);
+    for (size_t j = 0; j < sentences[i].size(); j++) {
+      std::cout << sentences[i][j].text << "/" << sentences[i][j].tag.value() << " ";
+      ok &= sentences[i][j].tag == batched[i][j].tag;
+    }
+    std::cout << "\n";
+  }
+  std::cout << "[tag_batch matches tag] " << (ok ? "OK" : "FAILED") << "\n";
+
+  // Anchor-split decoding must match the sparse Viterbi, also when run in parallel
+  tagger::Tagger sparse_tagger(FILEPATH, {tagger::Mode::SPARSE_VITERBI});
+  tagger::Config anchor_config = {tagger::Mode::ANCHOR_SPLIT};
+  anchor_config.parallel_threshold = 0;
+  tagger::Tagger anchor_tagger(FILEPATH, anchor_config);
+  bool anchor_ok = true;
+  for (const auto& sentence : sentences) {
+    auto sparse_tagged = sentence, anchor_tagged = sentence;
+    sparse_tagger.tag(sparse_tagged);
+    anchor_tagger.tag(anchor_tagged);
+    for (size_t j = 0; j < sentence.size(); j++)
+      anchor_ok &= sparse_tagged[j].tag == anchor_tagged[j].tag;
+  }
+  std::cout << "[anchor split matches sparse viterbi] " << (anchor_ok ? "OK" : "FAILED") << "\n";
+  ok &= anchor_ok;
+
+  // Chunked decoding of a long sentence must match the sequential Viterbi
+  std::vector<tokenizer::Token> long_sentence;
+  for (size_t k = 0; k < 64; k++) {
+    for (const auto& sentence : sentences)
+      long_sentence.insert(long_sentence.end(), sentence.begin(), sentence.end() - 1);
+  }
+  // The chunk count is forced, so that the boundaries are fixed up whatever the number of cores.
+  // The sentence is shifted, so that the boundaries also fall on the ambiguous words.
+  for (size_t no_chunks : {4, 7, 16}) {
+    tagger::Config sequential_config, chunked_config;
+    sequential_config.parallel_threshold = long_sentence.size() + 1;
+    chunked_config.parallel_threshold = 1;
+    chunked_config.parallel_chunks = no_chunks;
+    tagger::Tagger sequential_tagger(FILEPATH, sequential_config), chunked_tagger(FILEPATH, chunked_config);
+    bool chunked_ok = long_sentence.size() >= no_chunks * tagger::constants::kMinChunkLength + 16;
+    for (size_t shift = 0; shift < 16; shift++) {
+      std::vector<tokenizer::Token> shifted_sentence(long_sentence.begin() + shift, long_sentence.end());
+      auto sequential_tagged = shifted_sentence, chunked_tagged = shifted_sentence;
+      sequential_tagger.tag(sequential_tagged);
+      chunked_tagger.tag(chunked_tagged);
+      for (size_t j = 0; j < shifted_sentence.size(); j++)
+        chunked_ok &= sequential_tagged[j].tag == chunked_tagged[j].tag;
+    }
+    std::cout << "[chunked viterbi matches sequential, " << long_sentence.size() << " tokens, "
+              << no_chunks << " chunks] " << (chunked_ok ? "OK" : "FAILED") << "\n";
+    ok &= chunked_ok;
+  }
+
+  // Prefix cache must not change the results, even when it is too small to hold the sentences
+  for (size_t cache_bytes : {size_t(1) << 20, size_t(4096)}) {
+    tagger::Config cached_config;
+    cached_config.prefix_cache_bytes = cache_bytes;
+    tagger::Tagger cached_tagger(FILEPATH, cached_config);
+    bool cache_ok = true;
+    for (int pass = 0; pass < 2; pass++) {
+      for (const auto& sentence : sentences) {
+        auto cached_tagged = sentence;
+        cached_tagger.tag(cached_tagged);
+        for (size_t j = 0; j < sentence.size(); j++)
+          cache_ok &= cached_tagged[j].tag == sentence[j].tag;
+      }
+    }
+    auto stats = cached_tagger.prefix_cache_stats();
+    cache_ok &= stats.memory_bytes <= cache_bytes;
+    if (cache_bytes >= (size_t(1) << 20))
+      cache_ok &= stats.no_hits == sentences.size() && stats.no_evictions == 0;
+    std::cout << "[prefix cache, " << cache_bytes << " bytes] " << stats.no_hits << " hits, "
+              << stats.no_entries << " entries, " << stats.memory_bytes << " bytes "
+              << (cache_ok ? "OK" : "FAILED") << "\n";
+    ok &= cache_ok;
+  }
+
+  // Tagging with a warmed up workspace must not allocate
+  tagger::Workspace workspace;
+  for (auto& sentence : sentences)
+    tagger.tag(sentence, workspace);
+  tagger.tag_batch(batched, workspace);
+
+  size_t no_allocations_before = no_allocations;
+  for (auto& sentence : sentences)
+    tagger.tag(sentence, workspace);
+  tagger.tag_batch(batched, workspace);
+  size_t no_warm_allocations = no_allocations - no_allocations_before;
+
+  std::cout << "[warm workspace allocations] " << no_warm_allocations << "\n";
+  ok &= no_warm_allocations == 0;
+
+  // Streaming with an unbounded lag must match the full Viterbi,
+  // while a short lag must keep the tagging latency bounded.
+  for (size_t lag : {size_t(1000), size_t(2)}) {
+    tagger::StreamingTagger streaming(tagger, lag);
+    bool streaming_ok = true;
+    size_t no_agreed = 0, no_tokens = 0;
+    for (const auto& sentence : sentences) {
+      std::vector<tokenizer::Token> finalized;
+      for (const auto& token : sentence) {
+        streaming.push(token, finalized);
+        streaming_ok &= streaming.pending() <= lag;
+      }
+      streaming.flush(finalized);
+      streaming_ok &= finalized.size() == sentence.size();
+      for (size_t j = 0; j < finalized.size() && j < sentence.size(); j++)
+        no_agreed += finalized[j].tag == sentence[j].tag;
+      no_tokens += sentence.size();
+    }
+    if (lag >= 1000)
+      streaming_ok &= no_agreed == no_tokens;
+
+    std::cout << "[streaming, lag " << lag << "] " << no_agreed << "/" << no_tokens << " tags agree "
+              << (streaming_ok ? "OK" : "FAILED") << "\n";
+    ok &= streaming_ok;
+  }
+
+  // Streaming with warmed up columns must not allocate (the tokens are copied and the output reserved beforehand)
+  {
+    tagger::StreamingTagger streaming(tagger, 2);
+    std::vector<tokenizer::Token> finalized;
+    for (const auto& sentence : sentences) {
+      for (const auto& token : sentence)
+        streaming.push(token, finalized);
+      streaming.flush(finalized);
+    }
+
+    auto tokens = sentences;
+    finalized.clear();
+    size_t no_allocations_before = no_allocations;
+    for (auto& sentence : tokens) {
+      for (auto& token : sentence)
+        streaming.push(std::move(token), finalized);
+      streaming.flush(finalized);
+    }
+    size_t no_warm_streaming_allocations = no_allocations - no_allocations_before;
+
+    std::cout << "[warm streaming allocations] " << no_warm_streaming_allocations << "\n";
+    ok &= no_warm_streaming_allocations == 0;
+  }
+
+  // Streaming cannot recompute the columns cut down by pruning
+  bool pruned_rejected = true;
+  for (auto mode : {tagger::Mode::BEAM, tagger::Mode::GREEDY}) {
+    tagger::Tagger pruned_tagger(FILEPATH, {mode});
+    try {
+      tagger::StreamingTagger streaming(pruned_tagger);
+      pruned_rejected = false;
+    } catch (const std::invalid_argument&) {}
+  }
+  std::cout << "[streaming rejects pruned modes] " << (pruned_rejected ? "OK" : "FAILED") << "\n";
+  ok &= pruned_rejected;
+
+  return ok ? 0 : 1;
+}
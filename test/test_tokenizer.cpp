@@ -9,12 +9,20 @@ int main() {
     std::string text = "An ambiguous question is not always a bad one! But, considering the circumstances, I strongly disagree with it's intentions.";
     // std::string text = "``A violence is an art of destruction''.";
 
+    // Vocabulary - tokens get the ids of the interned words
+    phonemis::tokenizer::Vocabulary vocabulary;
+    for (const char* word : {"question", "is", "a", "it's", "I"})
+        vocabulary.intern(word);
+
     // Tokenize
-    auto tokens = phonemis::tokenizer::tokenize(text);
+    auto tokens = phonemis::tokenizer::tokenize(text, &vocabulary);
 
     // Print tokens
     for (const auto& token : tokens) {
-        std::cout << "[" << token.text << "] - white characters: " << token.whitespace.size() << std::endl;
+        std::cout << "[" << token.text << "] - white characters: " << token.whitespace.size();
+        if (token.id != phonemis::tokenizer::Vocabulary::kUnknown)
+            std::cout << ", id: " << token.id;
+        std::cout << std::endl;
     }
 
     return 0;
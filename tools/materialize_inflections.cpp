@@ -0,0 +1,37 @@
+#include <phonemis/phonemizer/lexicon_builder.h>
+#include <phonemis/utilities/io_utils.h>
+#include <exception>
+#include <iostream>
+#include <string>
+
+using namespace phonemis;
+
+// Lexicon build tool
+// Extends a lexicon with the materialized inflections of the listed words (see materialize_inflections).
+// Usage: materialize_inflections <en-us|en-gb> <lexicon.json> <words.txt> <output.json>
+// The word list holds one word per line (further columns, like the word counts, are ignored).
+int main(int argc, char** argv) {
+  if (argc != 5) {
+    std::cerr << "Usage: " << argv[0] << " <en-us|en-gb> <lexicon.json> <words.txt> <output.json>\n";
+    return 2;
+  }
+
+  const std::string language_name = argv[1];
+  if (language_name != phonemizer::to_string(phonemizer::Lang::EN_US) &&
+      language_name != phonemizer::to_string(phonemizer::Lang::EN_GB)) {
+    std::cerr << "Unknown language: " << language_name << "\n";
+    return 2;
+  }
+  const auto language = language_name == phonemizer::to_string(phonemizer::Lang::EN_GB) ?
+                        phonemizer::Lang::EN_GB : phonemizer::Lang::EN_US;
+
+  try {
+    const auto words = utilities::io_utils::load_words(argv[3]);
+    const size_t no_derived = phonemizer::materialize_inflections(language, argv[2], words, argv[4]);
+    std::cout << "Materialized " << no_derived << " of " << words.size() << " words into " << argv[4] << "\n";
+  } catch (const std::exception& e) {
+    std::cerr << e.what() << "\n";
+    return 1;
+  }
+  return 0;
+}